@@ -5,11 +5,215 @@
 #include "riaecs/include/container.h"
 #include "riaecs/include/registry.h"
 
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+
 namespace riaecs
 {
     using AssetFactoryRegistry = Registry<IAssetFactory>;
-    using AssetSourceRegistry = Registry<AssetSource>;
+
+    class RIAECS_API AssetSourceRegistry : public IAssetSourceRegistry
+    {
+    private:
+        struct SourceKey
+        {
+            std::string filePath;
+            size_t fileLoaderID;
+            size_t assetFactoryID;
+
+            bool operator==(const SourceKey &other) const
+            {
+                return filePath == other.filePath
+                    && fileLoaderID == other.fileLoaderID && assetFactoryID == other.assetFactoryID;
+            }
+        };
+
+        struct SourceKeyHash
+        {
+            size_t operator()(const SourceKey &key) const noexcept
+            {
+                size_t hash = std::hash<std::string>()(key.filePath);
+                hash ^= std::hash<size_t>()(key.fileLoaderID) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                hash ^= std::hash<size_t>()(key.assetFactoryID) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                return hash;
+            }
+        };
+
+        std::vector<std::unique_ptr<AssetSource>> sources_;
+        std::unordered_map<SourceKey, size_t, SourceKeyHash> sourceIndex_;
+        std::unordered_map<std::string, size_t> pathIndex_;
+        mutable std::shared_mutex mutex_;
+        std::atomic<bool> isFrozen_ = false;
+
+        std::shared_lock<std::shared_mutex> LockIfNotFrozen() const;
+
+    public:
+        AssetSourceRegistry() = default;
+        virtual ~AssetSourceRegistry() override = default;
+
+        AssetSourceRegistry(const AssetSourceRegistry&) = delete;
+        AssetSourceRegistry& operator=(const AssetSourceRegistry&) = delete;
+
+        /***************************************************************************************************************
+         * IAssetSourceRegistry Implementation
+        /**************************************************************************************************************/
+
+        // If the same source is already registered, the entry is dropped and the existing ID is returned. An
+        // entry that only differs in its file decoder or dependencies is rejected
+        size_t Add(std::unique_ptr<AssetSource> entry) override;
+        ReadOnlyObject<AssetSource> Get(size_t id) const override;
+        size_t GetCount() const override;
+
+        std::optional<size_t> Find(std::string_view filePath, size_t loaderID, size_t factoryID) const override;
+        std::optional<size_t> Find(std::string_view filePath) const override;
+
+        void Freeze() override;
+        bool IsFrozen() const override;
+    };
 
     using AssetContainer = Container<IAsset>;
 
+    class RIAECS_API AssetReferenceTable
+    {
+    private:
+        std::unordered_map<ID, size_t> refCounts_;
+        std::vector<ID> unreferenced_;
+        mutable std::mutex mutex_;
+
+    public:
+        AssetReferenceTable() = default;
+        virtual ~AssetReferenceTable() = default;
+
+        AssetReferenceTable(const AssetReferenceTable&) = delete;
+        AssetReferenceTable& operator=(const AssetReferenceTable&) = delete;
+
+        void AddRef(const ID &id);
+
+        // Returns false if the asset has already been collected and must be loaded again
+        bool TryAddRef(const ID &id);
+
+        // When the last reference is released, the asset is scheduled for unload
+        void Release(const ID &id);
+
+        size_t GetRefCount(const ID &id) const;
+
+        // Erase the assets which are still unreferenced from the container and return them.
+        // Call this at a frame boundary, when no one is reading the container
+        std::vector<std::unique_ptr<IAsset>> CollectUnreferenced(IAssetContainer &container);
+    };
+
+    template <typename T>
+    class AssetHandle
+    {
+    private:
+        ID id_;
+        AssetReferenceTable *table_ = nullptr;
+
+    public:
+        AssetHandle() = default;
+        ~AssetHandle()
+        {
+            Reset();
+        }
+
+        // The reference table must outlive the handle
+        AssetHandle(const ID &id, AssetReferenceTable &table) : id_(id), table_(&table)
+        {
+            table_->AddRef(id_);
+        }
+
+        AssetHandle(const AssetHandle &other) : id_(other.id_), table_(other.table_)
+        {
+            if (table_)
+                table_->AddRef(id_);
+        }
+
+        AssetHandle(AssetHandle &&other) noexcept : id_(other.id_), table_(other.table_)
+        {
+            other.table_ = nullptr;
+        }
+
+        AssetHandle& operator=(const AssetHandle &other)
+        {
+            if (this != &other)
+            {
+                if (other.table_)
+                    other.table_->AddRef(other.id_);
+
+                Reset();
+                id_ = other.id_;
+                table_ = other.table_;
+            }
+
+            return *this;
+        }
+
+        AssetHandle& operator=(AssetHandle &&other) noexcept
+        {
+            if (this != &other)
+            {
+                Reset();
+                id_ = other.id_;
+                table_ = other.table_;
+                other.table_ = nullptr;
+            }
+
+            return *this;
+        }
+
+        const ID &GetID() const { return id_; }
+        bool IsValid() const { return table_ != nullptr; }
+
+        void Reset()
+        {
+            if (!table_)
+                return;
+
+            table_->Release(id_);
+            table_ = nullptr;
+        }
+
+        ReadOnlyObject<T> Get(const IAssetContainer &container) const
+        {
+            if (!table_)
+                NotifyError({"Asset handle is empty"}, RIAECS_LOG_LOC);
+
+            ReadOnlyObject<IAsset> asset = container.Get(id_);
+            const T &typedAsset = static_cast<const T&>(asset());
+            return ReadOnlyObject<T>(asset.TakeLock(), typedAsset);
+        }
+    };
+
+    class RIAECS_API AssetUnloader
+    {
+    private:
+        std::thread worker_;
+        std::vector<std::unique_ptr<IAsset>> pendingAssets_;
+        size_t destroyingCount_ = 0;
+        bool isStopping_ = false;
+
+        std::mutex mutex_;
+        std::condition_variable pendingCondition_;
+        std::condition_variable idleCondition_;
+
+        void WorkerLoop();
+
+    public:
+        AssetUnloader();
+        virtual ~AssetUnloader();
+
+        AssetUnloader(const AssetUnloader&) = delete;
+        AssetUnloader& operator=(const AssetUnloader&) = delete;
+
+        // Call this at a frame boundary. Unreferenced assets are erased from the container on the calling thread
+        // and destroyed on the worker thread. Returns the number of assets scheduled for destruction
+        size_t Unload(IAssetContainer &container, AssetReferenceTable &table);
+
+        // Block until every scheduled asset has been destroyed
+        void WaitIdle();
+    };
+
 } // namespace riaecs
\ No newline at end of file
@@ -0,0 +1,243 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include "riaecs/include/interfaces/asset.h"
+#include "riaecs/include/interfaces/file.h"
+#include "riaecs/include/asset.h"
+#include "riaecs/include/thread_pool.h"
+#include "riaecs/include/asset_profiler.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <future>
+#include <atomic>
+#include <queue>
+
+namespace riaecs
+{
+    class RIAECS_API AssetLoader
+    {
+    private:
+        const IAssetSourceRegistry &sourceRegistry_;
+        const IFileLoaderRegistry &fileLoaderRegistry_;
+        const IAssetFactoryRegistry &assetFactoryRegistry_;
+        const IFileDecoderRegistry *fileDecoderRegistry_ = nullptr;
+
+        IAssetMemory *assetMemory_ = nullptr;
+        std::unordered_map<size_t, IAssetMemory*> factoryAssetMemories_;
+
+        AssetLoadProfiler *profiler_ = nullptr;
+
+        IAssetContainer &container_;
+        AssetReferenceTable &referenceTable_;
+
+        std::unordered_map<size_t, ID> loadedAssets_;
+        std::unordered_map<size_t, std::shared_future<ID>> loadingAssets_;
+        mutable std::mutex mutex_;
+
+        // Cancellable joiners wait here for the load they joined to finish or for their cancellation
+        std::condition_variable loadCondition_;
+
+        // Returns nullptr if the load is cancelled between the stages
+        std::unique_ptr<IAsset> RunStages(size_t sourceID, const std::atomic<bool> &isCancelled) const;
+
+    public:
+        // The registries, container and reference table must outlive the loader
+        AssetLoader
+        (
+            const IAssetSourceRegistry &sourceRegistry, const IFileLoaderRegistry &fileLoaderRegistry,
+            const IAssetFactoryRegistry &assetFactoryRegistry,
+            IAssetContainer &container, AssetReferenceTable &referenceTable
+        );
+
+        // Sources with a file decoder ID are decoded with the decoder registry between the file loader and the factory
+        AssetLoader
+        (
+            const IAssetSourceRegistry &sourceRegistry, const IFileLoaderRegistry &fileLoaderRegistry,
+            const IFileDecoderRegistry &fileDecoderRegistry, const IAssetFactoryRegistry &assetFactoryRegistry,
+            IAssetContainer &container, AssetReferenceTable &referenceTable
+        );
+        virtual ~AssetLoader() = default;
+
+        AssetLoader(const AssetLoader&) = delete;
+        AssetLoader& operator=(const AssetLoader&) = delete;
+
+        // Factories get the asset memory through PrepareWithMemory and CreateWithMemory.
+        // Set these before loading. The memory must outlive the assets created in it
+        void SetAssetMemory(IAssetMemory &memory);
+        void SetAssetMemory(size_t assetFactoryID, IAssetMemory &memory);
+
+        // Every stage of every load is recorded into the profiler. Set it before loading
+        void SetProfiler(AssetLoadProfiler &profiler) { profiler_ = &profiler; }
+        AssetLoadProfiler *GetProfiler() { return profiler_; }
+
+        // Returns the live asset of the source with one reference added for the caller.
+        // If the source is being loaded by another thread, waits for that load instead of loading it again
+        ID Acquire(size_t sourceID);
+
+        // Same as Acquire, but returns false without adding a reference if the load is cancelled
+        bool TryAcquire(size_t sourceID, const std::atomic<bool> &isCancelled, ID &assetID);
+
+        // Call after setting a flag passed to TryAcquire, so a caller joining another load notices it
+        void NotifyCancelled();
+
+        // Load the sources and all of their dependencies on the worker threads. Each asset starts loading as soon as
+        // its dependencies are committed, so independent branches load in parallel.
+        // Returns handles for every asset of the graph, dependencies first. Must not be called from a worker thread
+        std::vector<AssetHandle<IAsset>> LoadGraph(const std::vector<size_t> &sourceIDs, ThreadPool &workers);
+
+        // Returns true and the asset ID if the source has a live asset
+        bool FindLoaded(size_t sourceID, ID &assetID) const;
+
+        // Run the stages of the source again and return the new asset without touching the live one
+        std::unique_ptr<IAsset> Reload(size_t sourceID) const;
+
+        template <typename T>
+        AssetHandle<T> Load(size_t sourceID)
+        {
+            ID assetID = Acquire(sourceID);
+
+            // Hand the reference taken by Acquire over to the handle
+            AssetHandle<T> handle(assetID, referenceTable_);
+            referenceTable_.Release(assetID);
+
+            {
+                ReadOnlyObject<IAsset> asset = container_.Get(assetID);
+                if (dynamic_cast<const T*>(&asset()) == nullptr)
+                    NotifyError({"Asset type mismatch for source: " + std::to_string(sourceID)}, RIAECS_LOG_LOC);
+            }
+
+            return handle;
+        }
+
+        template <typename T>
+        AssetHandle<T> Load(std::string_view filePath)
+        {
+            std::optional<size_t> sourceID = sourceRegistry_.Find(filePath);
+            if (!sourceID)
+                NotifyError({"No asset source registered for path: " + std::string(filePath)}, RIAECS_LOG_LOC);
+
+            return Load<T>(*sourceID);
+        }
+
+        const IAssetSourceRegistry &GetSourceRegistry() const { return sourceRegistry_; }
+        IAssetContainer &GetContainer() { return container_; }
+        AssetReferenceTable &GetReferenceTable() { return referenceTable_; }
+    };
+
+    enum class AssetLoadStatus
+    {
+        Queued,
+        Loading,
+        Loaded,
+        Cancelled,
+        Failed,
+    };
+
+    class RIAECS_API AssetLoadRequest
+    {
+    private:
+        friend class AssetLoadQueue;
+
+        const size_t sourceID_;
+        AssetReferenceTable &referenceTable_;
+        const AssetLoadProfiler::Clock::time_point ENQUEUE_TIME_;
+
+        int priority_;
+        size_t priorityVersion_ = 0;
+        std::atomic<bool> isCancelled_ = false;
+
+        AssetLoadStatus status_ = AssetLoadStatus::Queued;
+        AssetHandle<IAsset> handle_;
+        std::exception_ptr error_ = nullptr;
+
+        mutable std::mutex mutex_;
+        mutable std::condition_variable statusCondition_;
+
+        void Finish(AssetLoadStatus status);
+
+    public:
+        AssetLoadRequest(size_t sourceID, int priority, AssetReferenceTable &referenceTable);
+        virtual ~AssetLoadRequest() = default;
+
+        AssetLoadRequest(const AssetLoadRequest&) = delete;
+        AssetLoadRequest& operator=(const AssetLoadRequest&) = delete;
+
+        size_t GetSourceID() const { return sourceID_; }
+        int GetPriority() const;
+        AssetLoadStatus GetStatus() const;
+        bool IsCancelled() const { return isCancelled_; }
+
+        // Block until the request is loaded, cancelled or failed. Rethrows the error of a failed load
+        AssetLoadStatus Wait() const;
+
+        // The request keeps the loaded asset referenced until it is destroyed
+        template <typename T>
+        AssetHandle<T> GetHandle() const
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (status_ != AssetLoadStatus::Loaded)
+                NotifyError({"Asset is not loaded for source: " + std::to_string(sourceID_)}, RIAECS_LOG_LOC);
+
+            return AssetHandle<T>(handle_.GetID(), referenceTable_);
+        }
+    };
+
+    class RIAECS_API AssetLoadQueue
+    {
+    private:
+        struct QueueEntry
+        {
+            int priority;
+            size_t sequence;
+            size_t priorityVersion;
+            std::shared_ptr<AssetLoadRequest> request;
+
+            // Higher priority first, then first in first out
+            bool operator<(const QueueEntry &other) const
+            {
+                if (priority != other.priority)
+                    return priority < other.priority;
+
+                return sequence > other.sequence;
+            }
+        };
+
+        AssetLoader &loader_;
+        ThreadPool &workers_;
+
+        std::priority_queue<QueueEntry> entries_;
+        std::unordered_set<std::shared_ptr<AssetLoadRequest>> activeRequests_;
+        size_t nextSequence_ = 0;
+        size_t queuedCount_ = 0;
+        size_t submittedTaskCount_ = 0;
+
+        mutable std::mutex mutex_;
+        std::condition_variable taskCondition_;
+
+        void RunNext();
+
+    public:
+        // The loader and the workers must outlive the queue
+        AssetLoadQueue(AssetLoader &loader, ThreadPool &workers);
+        virtual ~AssetLoadQueue();
+
+        AssetLoadQueue(const AssetLoadQueue&) = delete;
+        AssetLoadQueue& operator=(const AssetLoadQueue&) = delete;
+
+        // Requests with a higher priority are started first
+        std::shared_ptr<AssetLoadRequest> Enqueue(size_t sourceID, int priority);
+
+        // Only affects requests which have not started yet
+        void SetPriority(const std::shared_ptr<AssetLoadRequest> &request, int priority);
+
+        // Queued requests are dropped. Loading requests stop at the next factory stage
+        void Cancel(const std::shared_ptr<AssetLoadRequest> &request);
+        void CancelAll();
+
+        size_t GetQueuedCount() const;
+    };
+
+} // namespace riaecs
\ No newline at end of file
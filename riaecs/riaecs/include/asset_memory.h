@@ -0,0 +1,95 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include "riaecs/include/interfaces/asset.h"
+#include "riaecs/include/interfaces/memory.h"
+
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace riaecs
+{
+    constexpr size_t DEFAULT_ASSET_MEMORY_CHUNK_SIZE = 1024 * 1024;
+    constexpr size_t DEFAULT_ASSET_MEMORY_MAX_BLOCK_SIZE = 64 * 1024;
+    constexpr size_t ASSET_MEMORY_MIN_BLOCK_SIZE = 16;
+
+    // Serves power of two size classes from fixed size pools made by the pool and allocator factories,
+    // the same ones ECSWorld uses. Requests larger than the max block size get a pool of their own
+    class RIAECS_API AssetMemory : public IAssetMemory
+    {
+    private:
+        static constexpr size_t LARGE_SIZE_CLASS = static_cast<size_t>(-1);
+
+        struct Chunk
+        {
+            std::unique_ptr<IPool> pool;
+            std::unique_ptr<IAllocator> allocator;
+            size_t sizeClass;
+            size_t freeBlockCount;
+        };
+
+        std::unique_ptr<IPoolFactory> poolFactory_;
+        std::unique_ptr<IAllocatorFactory> allocatorFactory_;
+        const size_t CHUNK_SIZE_;
+
+        std::vector<size_t> blockSizes_;
+        std::vector<std::vector<Chunk*>> chunksWithFreeBlocks_;
+        std::map<const std::byte*, std::unique_ptr<Chunk>> chunks_;
+        size_t usedSize_ = 0;
+
+        mutable std::mutex mutex_;
+
+        Chunk &CreateChunk(size_t sizeClass, size_t poolSize, size_t blockSize);
+        void DestroyChunk(std::map<const std::byte*, std::unique_ptr<Chunk>>::iterator it);
+
+    public:
+        AssetMemory
+        (
+            std::unique_ptr<IPoolFactory> poolFactory, std::unique_ptr<IAllocatorFactory> allocatorFactory,
+            size_t chunkSize = DEFAULT_ASSET_MEMORY_CHUNK_SIZE, size_t maxBlockSize = DEFAULT_ASSET_MEMORY_MAX_BLOCK_SIZE
+        );
+        ~AssetMemory() override;
+
+        AssetMemory(const AssetMemory&) = delete;
+        AssetMemory& operator=(const AssetMemory&) = delete;
+
+        /***************************************************************************************************************
+         * IAssetMemory Implementation
+        /**************************************************************************************************************/
+
+        std::byte *Malloc(size_t size) override;
+        void Free(std::byte *ptr) override;
+        void Reset() override;
+
+        size_t GetUsedSize() const override;
+
+        size_t GetPoolCount() const;
+    };
+
+    // Owns a block of asset memory and frees it on destruction. The memory must outlive the block
+    class RIAECS_API AssetMemoryBlock
+    {
+    private:
+        IAssetMemory *memory_ = nullptr;
+        std::byte *data_ = nullptr;
+        size_t size_ = 0;
+
+    public:
+        AssetMemoryBlock() = default;
+        AssetMemoryBlock(IAssetMemory &memory, size_t size);
+        ~AssetMemoryBlock();
+
+        AssetMemoryBlock(const AssetMemoryBlock&) = delete;
+        AssetMemoryBlock& operator=(const AssetMemoryBlock&) = delete;
+
+        AssetMemoryBlock(AssetMemoryBlock &&other) noexcept;
+        AssetMemoryBlock& operator=(AssetMemoryBlock &&other) noexcept;
+
+        void Reset();
+
+        std::byte *GetData() const { return data_; }
+        size_t GetSize() const { return size_; }
+    };
+
+} // namespace riaecs
\ No newline at end of file
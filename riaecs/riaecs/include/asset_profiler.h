@@ -0,0 +1,100 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <mutex>
+
+namespace riaecs
+{
+    enum class AssetLoadStage : size_t
+    {
+        Load,
+        Decode,
+        Prepare,
+        Create,
+        Commit,
+        Count,
+    };
+    constexpr size_t ASSET_LOAD_STAGE_COUNT = static_cast<size_t>(AssetLoadStage::Count);
+
+    struct AssetLoadStats
+    {
+        size_t loadCount = 0;
+        std::chrono::nanoseconds stageTimes[ASSET_LOAD_STAGE_COUNT] = {};
+        std::chrono::nanoseconds queueWaitTime = std::chrono::nanoseconds::zero();
+        size_t bytesRead = 0;
+        size_t peakStagingSize = 0;
+
+        std::chrono::nanoseconds GetStageTime(AssetLoadStage stage) const
+        {
+            return stageTimes[static_cast<size_t>(stage)];
+        }
+
+        std::chrono::nanoseconds GetTotalTime() const;
+    };
+
+    // Aggregates the asset load stages per asset source and per asset factory.
+    // AssetLoader and AssetLoadQueue record into it when it is set on the loader
+    class RIAECS_API AssetLoadProfiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+    private:
+        struct TraceEvent
+        {
+            size_t sourceID;
+            AssetLoadStage stage;
+            size_t threadID;
+            Clock::duration start;
+            Clock::duration duration;
+        };
+
+        const Clock::time_point ORIGIN_;
+
+        std::map<size_t, AssetLoadStats> sourceStats_;
+        std::map<size_t, AssetLoadStats> factoryStats_;
+        std::map<size_t, std::string> sourcePaths_;
+
+        bool isTraceEnabled_ = false;
+        std::vector<TraceEvent> traceEvents_;
+
+        mutable std::mutex mutex_;
+
+    public:
+        AssetLoadProfiler();
+        virtual ~AssetLoadProfiler() = default;
+
+        AssetLoadProfiler(const AssetLoadProfiler&) = delete;
+        AssetLoadProfiler& operator=(const AssetLoadProfiler&) = delete;
+
+        void RecordStage
+        (
+            size_t sourceID, size_t factoryID, AssetLoadStage stage, Clock::time_point start, Clock::time_point end
+        );
+
+        // Called once per finished load. The staging size is the size the staging area reported before Commit
+        void RecordLoad(size_t sourceID, size_t factoryID, std::string_view filePath, size_t bytesRead, size_t stagingSize);
+
+        void RecordQueueWait(size_t sourceID, size_t factoryID, Clock::duration waitTime);
+
+        AssetLoadStats GetSourceStats(size_t sourceID) const;
+        AssetLoadStats GetFactoryStats(size_t factoryID) const;
+
+        // Factories and sources sorted by their total time, slowest first
+        std::string CreateReport() const;
+
+        // Keeps every stage as an event for WriteTrace. Off by default
+        void SetTraceEnabled(bool isEnabled);
+
+        // Writes the recorded events in the Chrome trace event format
+        void WriteTrace(std::string_view filePath) const;
+
+        void Clear();
+    };
+
+} // namespace riaecs
\ No newline at end of file
@@ -0,0 +1,92 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include "riaecs/include/interfaces/asset.h"
+#include "riaecs/include/asset_loader.h"
+#include "riaecs/include/thread_pool.h"
+
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+
+namespace riaecs
+{
+    class RIAECS_API FileWatcher
+    {
+    private:
+        // Normalized paths
+        std::unordered_set<std::string> watchedFiles_;
+
+#ifdef __linux__
+        // Files are watched through their directories so that editors which save by renaming are still detected
+        int inotifyFD_ = -1;
+        std::unordered_map<std::string, int> directoryWatches_;
+        std::unordered_map<int, std::filesystem::path> watchedDirectories_;
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> lastWriteTimes_;
+#endif
+
+    public:
+        FileWatcher();
+        virtual ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+
+        // Different spellings of the same file are the same path once normalized
+        static std::string NormalizePath(std::string_view filePath);
+
+        void Watch(std::string_view filePath);
+
+        // Returns the normalized paths written since the last call. Does not block
+        std::vector<std::string> Poll();
+    };
+
+    class RIAECS_API AssetWatcher
+    {
+    private:
+        AssetLoader &loader_;
+        const IAssetSourceRegistry &sourceRegistry_;
+        ThreadPool &workers_;
+
+        // Guards the file watcher and pathSources_, Watch may run while another thread updates. Keyed by
+        // the normalized path
+        FileWatcher fileWatcher_;
+        std::unordered_map<std::string, std::vector<size_t>> pathSources_;
+        std::mutex watchMutex_;
+
+        std::unordered_set<size_t> reloadingSources_;
+        std::unordered_set<size_t> changedWhileReloading_;
+        std::vector<std::pair<size_t, std::unique_ptr<IAsset>>> reloadedAssets_;
+        size_t runningTaskCount_ = 0;
+
+        std::mutex mutex_;
+        std::condition_variable idleCondition_;
+
+        // The lock must be held by the caller
+        void StartReload(size_t sourceID);
+        void RunReload(size_t sourceID);
+
+    public:
+        // The loader, the registry and the workers must outlive the watcher
+        AssetWatcher(AssetLoader &loader, const IAssetSourceRegistry &sourceRegistry, ThreadPool &workers);
+        virtual ~AssetWatcher();
+
+        AssetWatcher(const AssetWatcher&) = delete;
+        AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+        void Watch(size_t sourceID);
+        void WatchAll();
+
+        // Call this at a frame boundary, on the same thread as AssetUnloader::Unload.
+        // Starts reloading the live assets whose files changed and swaps the finished ones into their container slots,
+        // so existing IDs and handles see the new asset. Returns the number of swapped assets
+        size_t Update();
+
+        // Block until every started reload has finished
+        void WaitIdle();
+    };
+
+} // namespace riaecs
\ No newline at end of file
@@ -0,0 +1,58 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include "riaecs/include/interfaces/file.h"
+#include "riaecs/include/file.h"
+
+#include <vector>
+#include <string_view>
+#include <cstddef>
+
+namespace riaecs
+{
+    // Byte oriented LZ codec without entropy coding, decoding is a sequence of literal and match copies.
+    // Compressed data starts with a magic and the decompressed size, followed by sequences of
+    // [token][literal length...][literals][offset 2 bytes][match length...]. The last sequence has literals only
+    class RIAECS_API LZCodec
+    {
+    public:
+        static constexpr size_t HEADER_SIZE = 12;
+        static constexpr size_t MIN_MATCH_LENGTH = 4;
+        static constexpr size_t MAX_MATCH_OFFSET = 65535;
+
+        static std::vector<std::byte> Compress(const std::byte *data, size_t size);
+
+        // Returns the size written in the header. Notifies an error if the data is not LZCodec compressed
+        static size_t GetDecompressedSize(const std::byte *data, size_t size);
+
+        // The output size must equal GetDecompressedSize. Notifies an error for corrupted data
+        static void Decompress(const std::byte *data, size_t size, std::byte *output, size_t outputSize);
+
+        // Offline tool for building compressed packs
+        static void CompressFile(std::string_view srcFilePath, std::string_view dstFilePath);
+    };
+
+    // Decompresses MemoryFileData compressed by LZCodec into buffers taken from its pool, or into asset memory
+    class RIAECS_API LZFileDecoder : public IFileDecoder
+    {
+    private:
+        mutable ByteBufferPool bufferPool_;
+        IAssetMemory *memory_ = nullptr;
+
+    public:
+        LZFileDecoder() = default;
+
+        // The asset memory must outlive the decoded data
+        explicit LZFileDecoder(IAssetMemory &memory) : memory_(&memory) {}
+        ~LZFileDecoder() override = default;
+
+        /***************************************************************************************************************
+         * IFileDecoder Implementation
+        /**************************************************************************************************************/
+
+        std::unique_ptr<IFileData> Decode(const IFileData &fileData) const override;
+
+        const ByteBufferPool &GetBufferPool() const { return bufferPool_; }
+    };
+
+} // namespace riaecs
\ No newline at end of file
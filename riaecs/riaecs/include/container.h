@@ -78,8 +78,8 @@ namespace riaecs
                 size_t id = freeIndices_.back();
                 freeIndices_.pop_back();
 
+                // Keep the generation bumped by Erase so that stale IDs stay invalid
                 objects_[id] = std::move(object);
-                generations_[id] = ID_DEFAULT_GENERATION;
 
                 return ID(id, generations_[id]);
             }
@@ -11,12 +11,51 @@
 #include <unordered_map>
 #include <shared_mutex>
 #include <queue>
+#include <tuple>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <algorithm>
+#include <typeinfo>
+#include <typeindex>
 
 namespace riaecs
 {
     using ComponentFactoryRegistry = Registry<IComponentFactory>;
     using ComponentMaxCountRegistry = Registry<size_t>;
 
+    // Component values copied out of a template entity. Each value lives in its own aligned block
+    class RIAECS_API Prefab
+    {
+    public:
+        struct Component
+        {
+            size_t componentID = 0;
+            ComponentMeta meta;
+            std::byte *data = nullptr; // Null for tags
+            std::byte *coldData = nullptr; // Null unless the component is split
+        };
+
+    private:
+        std::vector<Component> components_;
+
+    public:
+        Prefab() = default;
+        ~Prefab();
+
+        Prefab(const Prefab&) = delete;
+        Prefab& operator=(const Prefab&) = delete;
+        Prefab(Prefab &&other) noexcept;
+        Prefab& operator=(Prefab &&other) noexcept;
+
+        // Copies the value at src, which may be null for tags, and the cold part of split components
+        void Add(size_t componentID, const ComponentMeta &meta, const std::byte *src, const std::byte *coldSrc = nullptr);
+
+        size_t GetComponentCount() const { return components_.size(); }
+        const Component &GetComponent(size_t index) const { return components_[index]; }
+    };
+
     class RIAECS_API ECSWorld : public IECSWorld
     {
     private:
@@ -28,20 +67,160 @@ namespace riaecs
         std::unique_ptr<IAllocatorFactory> allocatorFactory_ = nullptr;
         mutable bool isReady_ = false;
 
-        std::vector<bool> entityExistFlags_;
-        std::vector<Entity> entities_;
-        std::vector<Entity> freeEntities_;
-        std::unordered_set<Entity> emptyEntities_;
+        // A live slot holds its own entity. A free slot keeps its last generation and
+        // stores the index of the next free slot, so liveness is a single compare
+        std::vector<Entity> entitySlots_;
+        size_t freeSlotHead_ = ENTITY_NULL_INDEX;
 
         static size_t nextRegisterIndex_;
         std::unordered_map<size_t, Entity> registeredEntities_;
 
         std::vector<std::unique_ptr<IPool>> componentPools_;
         std::vector<std::unique_ptr<IAllocator>> componentAllocators_;
+        std::vector<ComponentMeta> componentMetas_;
 
-        std::unordered_map<Entity, std::unordered_set<size_t>> entityToComponents_;
-        std::unordered_map<size_t, std::unordered_set<Entity>> componentToEntities_;
-        std::unordered_map<std::pair<Entity, size_t>, std::byte*, PairHash, PairEqual> entityComponentToData_;
+        // Cold parts of split components, null for other components
+        std::vector<std::unique_ptr<IPool>> coldPools_;
+        std::vector<std::unique_ptr<IAllocator>> coldAllocators_;
+
+        // One bit per component ID for each entity index, signatureWordCount_ words per entity
+        size_t signatureWordCount_ = 0;
+        std::vector<uint64_t> signatures_;
+
+        // Changed ticks are written under the shared lock by GetMutableComponent and GetMutableGroup. The copies only happen
+        // under the unique lock, when the dense arrays grow or are reordered
+        struct AtomicTick
+        {
+            std::atomic<uint64_t> value;
+
+            AtomicTick(uint64_t tick = 0) : value(tick) {}
+            AtomicTick(const AtomicTick &other) : value(other.value.load(std::memory_order_relaxed)) {}
+            AtomicTick &operator=(const AtomicTick &other)
+            {
+                value.store(other.value.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                return *this;
+            }
+        };
+
+        // A sparse set per component. The dense arrays are packed and parallel, sparse maps an entity index
+        // to its dense position. Ticks are compared against the tick a system last ran at
+        static constexpr size_t NULL_POSITION = static_cast<size_t>(-1);
+        struct ComponentStorage
+        {
+            std::vector<Entity> entities;
+            std::vector<std::byte*> data; // Null for tags
+            std::vector<std::byte*> coldData; // Null unless the component is split
+            std::vector<uint64_t> addedTicks;
+            std::vector<AtomicTick> changedTicks;
+            std::vector<size_t> sparse;
+
+            size_t Find(size_t entityIndex) const
+            {
+                return entityIndex < sparse.size() ? sparse[entityIndex] : NULL_POSITION;
+            }
+        };
+        std::vector<ComponentStorage> componentStorages_;
+        std::atomic<uint64_t> currentTick_ = 1;
+        std::vector<Entity> emptyEntities_;
+
+        // Round robin position of the time budgeted compaction
+        size_t compactCursor_ = 0;
+
+        std::vector<Entity> CollectByTick(size_t componentID, uint64_t sinceTick, bool added) const;
+
+        // Events are only queued for components which have observers, in the order the changes happened
+        struct ComponentEvent
+        {
+            Entity entity;
+            bool isAdd;
+        };
+        struct ComponentObservers
+        {
+            std::vector<IComponentObserver*> observers;
+            std::vector<ComponentEvent> events;
+        };
+        std::vector<ComponentObservers> componentObservers_;
+
+        // data caches the storage pointers and is refreshed whenever an owned storage changes
+        struct OwningGroup
+        {
+            std::vector<uint64_t> mask;
+            GroupData data;
+        };
+        std::vector<OwningGroup> groups_;
+        std::vector<size_t> componentGroups_; // The owning group of each component, NULL_POSITION if none
+
+        // The distinct values of each shared component, reference counted and indexed by their hash.
+        // The hash is kept so an instance can be unindexed without hashing its value again
+        struct SharedInstance
+        {
+            size_t refCount = 0;
+            size_t hash = 0;
+        };
+        struct SharedInstances
+        {
+            std::unordered_map<std::byte*, SharedInstance> entries;
+            std::unordered_multimap<size_t, std::byte*> byHash;
+        };
+        std::vector<SharedInstances> sharedInstances_;
+
+        uint64_t *GetSignature(size_t index) { return signatures_.data() + index * signatureWordCount_; }
+        const uint64_t *GetSignature(size_t index) const { return signatures_.data() + index * signatureWordCount_; }
+
+        bool IsSlotAlive(size_t index) const { return entitySlots_[index].GetIndex() == index; }
+        void ValidateEntity(const Entity &entity) const;
+
+        // These expect mutex_ to be held and the arguments to be validated
+        Entity AllocateEntity();
+        void ReleaseEntity(const Entity &entity);
+        void AddComponentData
+        (
+            const Entity &entity, size_t componentID, ComponentConstructor constructor, void *context, 
+            const std::byte *coldSource = nullptr
+        );
+        void FreeComponentData(size_t componentID, std::byte *data, std::byte *coldData);
+
+        std::byte *FindInstance(size_t componentID, const std::byte *value, size_t hash) const;
+
+        // Takes an unindexed pool block of a shared component and returns the instance to reference,
+        // freeing the block if an equal instance already exists
+        std::byte *ShareInstance(size_t componentID, std::byte *data);
+
+        // Same for a value outside the pool, which is consumed. A block is only taken for a new value
+        std::byte *ShareValue(size_t componentID, std::byte *value);
+        void UnindexInstance(size_t componentID, std::byte *data);
+        void ReleaseInstance(size_t componentID, std::byte *data);
+        void ReleaseAllComponents();
+
+        void InsertToStorage(size_t componentID, const Entity &entity, std::byte *data, std::byte *coldData);
+
+        // Returns the blocks of the erased component
+        std::pair<std::byte*, std::byte*> EraseFromStorage(size_t componentID, size_t entityIndex);
+
+        // Puts dense position order[i] at position i
+        void ReorderStorage(size_t componentID, const std::vector<size_t> &order);
+
+        // Moves the components around inside their own blocks so memory follows dense order. Returns
+        // false when the deadline passes first, the storage stays valid and can be finished later
+        bool RelocateStorage
+        (
+            size_t componentID, 
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max()
+        );
+        bool CompactStorage(size_t componentID, std::chrono::steady_clock::time_point deadline);
+
+        void SwapInStorage(size_t componentID, size_t positionA, size_t positionB);
+
+        // Enter moves a member into the packed front of every owned storage, Leave moves it out. Both
+        // are called for owned components only, Enter after the insertion and Leave before the erase
+        void EnterGroup(size_t groupID, size_t entityIndex);
+        void LeaveGroup(size_t groupID, size_t entityIndex);
+        void RefreshGroup(size_t groupID);
+
+        static bool TestSignature(const uint64_t *signature, size_t componentID)
+        {
+            return (signature[componentID / 64] >> (componentID % 64)) & 1;
+        }
 
     public:
         ECSWorld() = default;
@@ -68,15 +247,114 @@ namespace riaecs
         Entity CreateEntity() override;
         void DestroyEntity(const Entity &entity) override;
 
+        void CreateEntities(size_t count, const std::vector<size_t> &componentIDs, std::vector<Entity> &out) override;
+        void DestroyEntities(const std::vector<Entity> &entities) override;
+        void Clear() override;
+
+        void AddComponentObserver(size_t componentID, IComponentObserver &observer) override;
+        void RemoveComponentObserver(size_t componentID, IComponentObserver &observer) override;
+        void FlushObservers() override;
+
+        Prefab CreatePrefab(const Entity &entity) const override;
+        void Instantiate(const Prefab &prefab, size_t count, std::vector<Entity> &out) override;
+
         void RegisterEntity(size_t index, const Entity &entity) override;
         Entity GetRegisteredEntity(size_t index) const override;
 
         void AddComponent(const Entity &entity, size_t componentID) override;
+        void AddComponent
+        (
+            const Entity &entity, size_t componentID, ComponentConstructor constructor, void *context
+        ) override;
         void RemoveComponent(const Entity &entity, size_t componentID) override;
         bool HasComponent(const Entity &entity, size_t componentID) const override;
-        ReadOnlyObject<std::byte*> GetComponent(const Entity &entity, size_t componentID) override;
+        ReadOnlyObject<const std::byte*> GetComponent(const Entity &entity, size_t componentID) override;
+        ReadOnlyObject<std::byte*> GetMutableComponent(const Entity &entity, size_t componentID) override;
+        ReadOnlyObject<const std::byte*> GetColdComponent(const Entity &entity, size_t componentID) override;
+        ReadOnlyObject<std::byte*> GetMutableColdComponent(const Entity &entity, size_t componentID) override;
+
+        uint64_t GetTick() const override;
+        uint64_t AdvanceTick() override;
+        std::vector<Entity> Added(size_t componentID, uint64_t sinceTick) const override;
+        std::vector<Entity> Changed(size_t componentID, uint64_t sinceTick) const override;
+
+        void Compact() override;
+        bool Compact(std::chrono::microseconds budget) override;
+
+        void SortComponent(size_t componentID, const ComponentComparator &less) override;
+        void SortComponentLike(size_t componentID, size_t leaderComponentID) override;
+
+        size_t CreateGroup(const std::vector<size_t> &ownedComponentIDs) override;
+        ReadOnlyObject<GroupData> GetGroup(size_t groupID) const override;
+        ReadOnlyObject<GroupData> GetMutableGroup(size_t groupID) override;
+
+        void ModifySharedComponent
+        (
+            const Entity &entity, size_t componentID, ComponentModifier modifier, void *context
+        ) override;
+        std::vector<SharedGroup> GroupByShared(size_t componentID) const override;
+
+        ReadOnlyObject<std::vector<Entity>> View(size_t componentID) const override;
+        std::vector<Entity> Query
+        (
+            const std::vector<size_t> &includeIDs, const std::vector<size_t> &excludeIDs = {}
+        ) const override;
+
+        const ComponentMeta &GetComponentMeta(size_t componentID) const override;
+    };
 
-        ReadOnlyObject<std::unordered_set<Entity>> View(size_t componentID) const override;
+    constexpr size_t INVALID_COMPONENT_ID = static_cast<size_t>(-1);
+
+    // Component IDs are kept in the DLL keyed by type, so every module sees the ID the registering module
+    // set. type_index compares mangled names, which tells apart types in different anonymous namespaces.
+    // A type has one ID in the process, setting a different one throws
+    RIAECS_API void SetComponentTypeID(std::type_index type, size_t componentID);
+    RIAECS_API size_t FindComponentTypeID(std::type_index type);
+
+    // The component ID of a type, set once by ComponentRegistrar. Each module caches the ID from the DLL
+    // on first use, after that reading it is a single load, so typed APIs need neither the ID argument
+    // nor a registry lookup. The ID is not per registry: a type must get the same ID in every registry
+    // that registers it, so register typed components through the global registry, or in the same order
+    // in each local one
+    template <typename T>
+    class ComponentType
+    {
+    private:
+        static inline std::atomic<size_t> cachedID_ = INVALID_COMPONENT_ID;
+
+        static size_t LoadID()
+        {
+            size_t componentID = cachedID_.load(std::memory_order_relaxed);
+            if (componentID != INVALID_COMPONENT_ID)
+                return componentID;
+
+            // IDs never change once set, so caching the first one found is safe
+            componentID = FindComponentTypeID(typeid(T));
+            if (componentID != INVALID_COMPONENT_ID)
+                cachedID_.store(componentID, std::memory_order_relaxed);
+
+            return componentID;
+        }
+
+    public:
+        static void SetID(size_t componentID)
+        {
+            SetComponentTypeID(typeid(T), componentID);
+            cachedID_.store(componentID, std::memory_order_relaxed);
+        }
+
+        static size_t GetID()
+        {
+            size_t componentID = LoadID();
+            if (componentID == INVALID_COMPONENT_ID)
+                NotifyError({"Component type is not registered"}, RIAECS_LOG_LOC);
+
+            return componentID;
+        }
+
+        static bool IsRegistered() { return LoadID() != INVALID_COMPONENT_ID; }
+
+        static constexpr ComponentMeta META = MakeComponentMeta<T>();
     };
 
     template <typename T>
@@ -88,8 +366,8 @@ namespace riaecs
             if (data == nullptr)
                 return nullptr;
 
-            T* component = new(data) T();
-            return reinterpret_cast<std::byte*>(component);
+            ComponentType<T>::META.Construct(data);
+            return data;
         }
 
         void Destroy(std::byte *data) const override
@@ -97,16 +375,233 @@ namespace riaecs
             if (data == nullptr)
                 return;
 
-            T* component = reinterpret_cast<T*>(data);
-            component->~T();
+            ComponentType<T>::META.Destroy(data);
         }
 
         size_t GetProductSize() const override
         {
-            return sizeof(T);
+            return sizeof(ComponentHot<T>);
+        }
+
+        const ComponentMeta &GetMeta() const override
+        {
+            return ComponentType<T>::META;
         }
     };
 
+    // Read only access, which leaves the change tick alone. Writes go through GetMutableComponent. The hot
+    // part for split components
+    template <typename T>
+    ReadOnlyObject<const ComponentHot<T>*> GetComponent(IECSWorld &world, const Entity &entity)
+    {
+        return GetComponent<ComponentHot<T>>(world, entity, ComponentType<T>::GetID());
+    }
+
+    template <typename T>
+    ReadOnlyObject<ComponentHot<T>*> GetMutableComponent(IECSWorld &world, const Entity &entity)
+    {
+        static_assert(!IsSharedComponent<T>::value, "Shared components are modified with ModifySharedComponent");
+        return GetMutableComponent<ComponentHot<T>>(world, entity, ComponentType<T>::GetID());
+    }
+
+    template <typename T>
+    ReadOnlyObject<const ComponentCold<T>*> GetColdComponent(IECSWorld &world, const Entity &entity)
+    {
+        ReadOnlyObject<const std::byte*> componentData = world.GetColdComponent(entity, ComponentType<T>::GetID());
+        const ComponentCold<T>* data = reinterpret_cast<const ComponentCold<T>*>(componentData());
+        return ReadOnlyObject<const ComponentCold<T>*>(std::move(componentData.TakeLock()), data);
+    }
+
+    template <typename T>
+    ReadOnlyObject<ComponentCold<T>*> GetMutableColdComponent(IECSWorld &world, const Entity &entity)
+    {
+        ReadOnlyObject<std::byte*> componentData = world.GetMutableColdComponent(entity, ComponentType<T>::GetID());
+        ComponentCold<T>* data = reinterpret_cast<ComponentCold<T>*>(componentData());
+        return ReadOnlyObject<ComponentCold<T>*>(std::move(componentData.TakeLock()), data);
+    }
+
+    template <typename T>
+    std::vector<Entity> Added(const IECSWorld &world, uint64_t sinceTick)
+    {
+        return world.Added(ComponentType<T>::GetID(), sinceTick);
+    }
+
+    template <typename T>
+    std::vector<Entity> Changed(const IECSWorld &world, uint64_t sinceTick)
+    {
+        return world.Changed(ComponentType<T>::GetID(), sinceTick);
+    }
+
+    template <typename T, typename Less>
+    void SortComponent(IECSWorld &world, Less less)
+    {
+        world.SortComponent
+        (
+            ComponentType<T>::GetID(), 
+            [&less](const Entity &, const std::byte *lhs, const Entity &, const std::byte *rhs)
+            {
+                return less
+                (
+                    *reinterpret_cast<const ComponentHot<T>*>(lhs), *reinterpret_cast<const ComponentHot<T>*>(rhs)
+                );
+            }
+        );
+    }
+
+    // Sorts by the key the extractor returns for each component, in ascending order
+    template <typename T, typename KeyExtractor>
+    void SortComponentByKey(IECSWorld &world, KeyExtractor key)
+    {
+        SortComponent<T>
+        (
+            world, [&key](const ComponentHot<T> &lhs, const ComponentHot<T> &rhs) { return key(lhs) < key(rhs); }
+        );
+    }
+
+    template <typename T, typename Leader>
+    void SortComponentLike(IECSWorld &world)
+    {
+        world.SortComponentLike(ComponentType<T>::GetID(), ComponentType<Leader>::GetID());
+    }
+
+    template <typename... Ts>
+    size_t CreateGroup(IECSWorld &world)
+    {
+        return world.CreateGroup({ComponentType<Ts>::GetID()...});
+    }
+
+    template <bool IsMutable, typename... Ts, typename Func, size_t... Is>
+    void ForEachInGroupColumns(const GroupData &data, Func &func, std::index_sequence<Is...>)
+    {
+        for (size_t i = 0; i < data.size; ++i)
+        {
+            func
+            (
+                data.entities[i], 
+                *reinterpret_cast<std::conditional_t<IsMutable, ComponentHot<Ts>, const ComponentHot<Ts>>*>(data.columns[Is][i])...
+            );
+        }
+    }
+
+    template <bool IsMutable, typename... Ts, typename Func>
+    void ForEachInGroupData(const GroupData &data, Func &func)
+    {
+        static_assert((!ComponentType<Ts>::META.isTag && ...), "Tags have no data to iterate");
+
+        const size_t componentIDs[] = {ComponentType<Ts>::GetID()...};
+        if (data.componentIDs.size() != sizeof...(Ts) || !std::equal(data.componentIDs.begin(), data.componentIDs.end(), componentIDs))
+            NotifyError({"Component types do not match the group"}, RIAECS_LOG_LOC);
+
+        ForEachInGroupColumns<IsMutable, Ts...>(data, func, std::index_sequence_for<Ts...>{});
+    }
+
+    // Calls func(entity, const Ts&...) for every member of the group, walking the owned storages in parallel.
+    // Ts are the group's components in the order the group was created with. Split components pass their hot part
+    template <typename... Ts, typename Func>
+    void ForEachInGroup(const IECSWorld &world, size_t groupID, Func func)
+    {
+        ReadOnlyObject<GroupData> group = world.GetGroup(groupID);
+        ForEachInGroupData<false, Ts...>(group(), func);
+    }
+
+    // Same as ForEachInGroup but passes Ts&... and stamps every member's components as changed
+    template <typename... Ts, typename Func>
+    void ForEachInGroupMutable(IECSWorld &world, size_t groupID, Func func)
+    {
+        ReadOnlyObject<GroupData> group = world.GetMutableGroup(groupID);
+        ForEachInGroupData<true, Ts...>(group(), func);
+    }
+
+    // Calls modifier(T&) on the entity's own copy of the shared component
+    template <typename T, typename Modifier>
+    void ModifySharedComponent(IECSWorld &world, const Entity &entity, Modifier modifier)
+    {
+        ComponentModifier componentModifier = [](std::byte *data, void *context)
+        {
+            (*static_cast<Modifier*>(context))(*reinterpret_cast<T*>(data));
+        };
+
+        world.ModifySharedComponent(entity, ComponentType<T>::GetID(), componentModifier, &modifier);
+    }
+
+    // Calls func(const T&, const std::vector<Entity>&) once per distinct value of the shared component
+    template <typename T, typename Func>
+    void ForEachSharedGroup(const IECSWorld &world, Func func)
+    {
+        for (const SharedGroup &group : world.GroupByShared(ComponentType<T>::GetID()))
+            func(*reinterpret_cast<const T*>(group.data), group.entities);
+    }
+
+    template <typename T>
+    void AddComponent(IECSWorld &world, const Entity &entity)
+    {
+        world.AddComponent(entity, ComponentType<T>::GetID());
+    }
+
+    // Constructs T from args in its pool block, under the same lock as the allocation. For split components
+    // args construct the hot part and the cold part is default constructed
+    template <typename T, typename... Args>
+    void EmplaceComponent(IECSWorld &world, const Entity &entity, Args&&... args)
+    {
+        std::tuple<Args&&...> argTuple(std::forward<Args>(args)...);
+        ComponentConstructor constructor = [](std::byte *data, void *context)
+        {
+            std::apply
+            (
+                [data](auto&&... values)
+                {
+                    // Aggregates have no constructor to call with parentheses before C++20
+                    using Hot = ComponentHot<T>;
+                    if constexpr (std::is_aggregate_v<Hot>)
+                        new(data) Hot{std::forward<decltype(values)>(values)...};
+                    else
+                        new(data) Hot(std::forward<decltype(values)>(values)...);
+                },
+                std::move(*static_cast<std::tuple<Args&&...>*>(context))
+            );
+        };
+
+        world.AddComponent(entity, ComponentType<T>::GetID(), constructor, &argTuple);
+    }
+
+    // Moves or copies an existing value into the pool block
+    template <typename T>
+    void AddComponent(IECSWorld &world, const Entity &entity, T &&component)
+    {
+        static_assert
+        (
+            !ComponentParts<std::decay_t<T>>::IS_SPLIT, 
+            "Split components have no whole value to add, use EmplaceComponent with the hot part's arguments"
+        );
+
+        EmplaceComponent<std::decay_t<T>>(world, entity, std::forward<T>(component));
+    }
+
+    template <typename T>
+    void RemoveComponent(IECSWorld &world, const Entity &entity)
+    {
+        world.RemoveComponent(entity, ComponentType<T>::GetID());
+    }
+
+    template <typename T>
+    bool HasComponent(const IECSWorld &world, const Entity &entity)
+    {
+        return world.HasComponent(entity, ComponentType<T>::GetID());
+    }
+
+    template <typename T>
+    ReadOnlyObject<std::vector<Entity>> View(const IECSWorld &world)
+    {
+        return world.View(ComponentType<T>::GetID());
+    }
+
+    // Entities which have every component in Ts
+    template <typename... Ts>
+    std::vector<Entity> Query(const IECSWorld &world)
+    {
+        return world.Query({ComponentType<Ts>::GetID()...});
+    }
+
     template <typename T>
     class SystemFactory : public ISystemFactory
     {
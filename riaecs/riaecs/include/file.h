@@ -3,9 +3,193 @@
 
 #include "riaecs/include/interfaces/file.h"
 #include "riaecs/include/registry.h"
+#include "riaecs/include/asset_memory.h"
+
+#include <vector>
+#include <queue>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 namespace riaecs
 {
     using FileLoaderRegistry = Registry<IFileLoader>;
+    using FileDecoderRegistry = Registry<IFileDecoder>;
+
+    // Default initialises new elements, so growing a buffer leaves bytes uninitialised instead of zeroing them
+    template <typename T>
+    class DefaultInitAllocator : public std::allocator<T>
+    {
+    public:
+        template <typename U>
+        struct rebind { using other = DefaultInitAllocator<U>; };
+
+        DefaultInitAllocator() noexcept = default;
+
+        template <typename U>
+        DefaultInitAllocator(const DefaultInitAllocator<U> &) noexcept {}
+
+        template <typename U>
+        void construct(U *ptr) noexcept(std::is_nothrow_default_constructible_v<U>) { ::new(static_cast<void*>(ptr)) U; }
+
+        template <typename U, typename... Args>
+        void construct(U *ptr, Args&&... args) { ::new(static_cast<void*>(ptr)) U(std::forward<Args>(args)...); }
+    };
+
+    // Buffers the decoders fill completely, resizing a reused one costs nothing
+    using ByteBuffer = std::vector<std::byte, DefaultInitAllocator<std::byte>>;
+
+    // Keeps released byte buffers so that repeated decodes reuse their memory instead of allocating
+    class RIAECS_API ByteBufferPool
+    {
+    private:
+        std::vector<ByteBuffer> freeBuffers_;
+        const size_t MAX_FREE_BUFFER_COUNT_;
+        mutable std::mutex mutex_;
+
+    public:
+        explicit ByteBufferPool(size_t maxFreeBufferCount = 8);
+        virtual ~ByteBufferPool() = default;
+
+        ByteBufferPool(const ByteBufferPool&) = delete;
+        ByteBufferPool& operator=(const ByteBufferPool&) = delete;
+
+        // Returns a buffer of the size, reusing the smallest released buffer which is large enough. The
+        // contents are left uninitialised and must be written before they are read
+        ByteBuffer Acquire(size_t size);
+        void Release(ByteBuffer buffer);
+
+        size_t GetFreeCount() const;
+    };
+
+    class RIAECS_API MemoryFileData : public IFileData
+    {
+    private:
+        std::vector<std::byte> bytes_;
+        ByteBuffer pooledBytes_;
+        ByteBufferPool *pool_ = nullptr;
+        AssetMemoryBlock block_;
+
+    public:
+        MemoryFileData() = default;
+        explicit MemoryFileData(std::vector<std::byte> bytes) : bytes_(std::move(bytes)) {}
+
+        // The bytes are released back to the pool on destruction. The pool must outlive the data
+        MemoryFileData(ByteBuffer bytes, ByteBufferPool &pool) : pooledBytes_(std::move(bytes)), pool_(&pool) {}
+
+        // The bytes live in asset memory and are freed with the block
+        explicit MemoryFileData(AssetMemoryBlock block) : block_(std::move(block)) {}
+        ~MemoryFileData() override;
+
+        MemoryFileData(const MemoryFileData&) = delete;
+        MemoryFileData& operator=(const MemoryFileData&) = delete;
+
+        const std::byte *GetData() const
+        {
+            if (block_.GetData())
+                return block_.GetData();
+            return pool_ ? pooledBytes_.data() : bytes_.data();
+        }
+
+        size_t GetSize() const
+        {
+            if (block_.GetData())
+                return block_.GetSize();
+            return pool_ ? pooledBytes_.size() : bytes_.size();
+        }
+    };
+
+    class RIAECS_API FileStream : public IFileStream
+    {
+    private:
+        std::ifstream file_;
+        size_t size_ = 0;
+
+    public:
+        explicit FileStream(std::string_view filePath);
+        ~FileStream() override = default;
+
+        FileStream(const FileStream&) = delete;
+        FileStream& operator=(const FileStream&) = delete;
+
+        /***************************************************************************************************************
+         * IFileStream Implementation
+        /**************************************************************************************************************/
+
+        size_t GetSize() const override { return size_; }
+        size_t Read(size_t offset, std::byte *buffer, size_t size) override;
+    };
+
+    // Loads the whole file into MemoryFileData, or opens it as a FileStream for streaming factories
+    class RIAECS_API BinaryFileLoader : public IFileLoader, public IFileStreamLoader
+    {
+    private:
+        IAssetMemory *memory_ = nullptr;
+
+    public:
+        BinaryFileLoader() = default;
+
+        // The file data is read into the asset memory, which must outlive the loaded data
+        explicit BinaryFileLoader(IAssetMemory &memory) : memory_(&memory) {}
+        ~BinaryFileLoader() override = default;
+
+        /***************************************************************************************************************
+         * IFileLoader Implementation
+        /**************************************************************************************************************/
+
+        std::unique_ptr<IFileData> Load(std::string_view filePath) const override;
+
+        /***************************************************************************************************************
+         * IFileStreamLoader Implementation
+        /**************************************************************************************************************/
+
+        std::unique_ptr<IFileStream> Open(std::string_view filePath) const override;
+    };
+
+    // Reads the stream ahead on its own thread into a bounded set of chunk buffers
+    class RIAECS_API FileChunkReader : public IFileChunkReader
+    {
+    private:
+        struct FilledChunk
+        {
+            size_t bufferIndex;
+            size_t size;
+        };
+
+        std::unique_ptr<IFileStream> stream_;
+        const size_t CHUNK_SIZE_;
+
+        std::vector<std::unique_ptr<std::byte[]>> buffers_;
+        std::vector<size_t> freeBufferIndices_;
+        std::queue<FilledChunk> filledChunks_;
+        size_t consumingBufferIndex_;
+        bool isReadEnd_ = false;
+        bool isStopping_ = false;
+        std::exception_ptr error_ = nullptr;
+
+        std::thread readThread_;
+        std::mutex mutex_;
+        std::mutex streamMutex_;
+        std::condition_variable freeCondition_;
+        std::condition_variable filledCondition_;
+
+        void ReadLoop();
+
+    public:
+        FileChunkReader(std::unique_ptr<IFileStream> stream, size_t chunkSize, size_t maxBufferedChunkCount);
+        ~FileChunkReader() override;
+
+        FileChunkReader(const FileChunkReader&) = delete;
+        FileChunkReader& operator=(const FileChunkReader&) = delete;
+
+        /***************************************************************************************************************
+         * IFileChunkReader Implementation
+        /**************************************************************************************************************/
+
+        size_t GetSize() const override { return stream_->GetSize(); }
+        bool Next(const std::byte *&data, size_t &size) override;
+        size_t ReadRange(size_t offset, std::byte *buffer, size_t size) override;
+    };
 
 } // namespace riaecs
\ No newline at end of file
@@ -12,6 +12,8 @@ namespace riaecs
 {
     extern RIAECS_API std::unique_ptr<IComponentFactoryRegistry> gComponentFactoryRegistry;
     extern RIAECS_API std::unique_ptr<IComponentMaxCountRegistry> gComponentMaxCountRegistry;
+
+    // MAX_COUNT is the number of distinct values for shared components
     template <typename COMPONENT, size_t MAX_COUNT> 
     class ComponentRegistrar
     {
@@ -23,6 +25,7 @@ namespace riaecs
         {
             componentID_ = gComponentFactoryRegistry->Add(std::make_unique<ComponentFactory<COMPONENT>>());
             gComponentMaxCountRegistry->Add(std::make_unique<size_t>(MAX_COUNT));
+            ComponentType<COMPONENT>::SetID(componentID_);
         }
 
         size_t operator()() const
@@ -82,6 +85,14 @@ namespace riaecs
             = gAssetSourceRegistry->Add(std::make_unique<AssetSource>(std::move(path), loaderID, factoryID));
         }
 
+        AssetSourceRegistrar(std::string path, size_t loaderID, size_t factoryID, std::vector<size_t> dependencyIDs)
+        {
+            assetSourceID_ = gAssetSourceRegistry->Add
+            (
+                std::make_unique<AssetSource>(std::move(path), loaderID, factoryID, std::move(dependencyIDs))
+            );
+        }
+
         size_t operator()() const
         {
             return assetSourceID_;
@@ -4,9 +4,12 @@
 #include "riaecs/include/interfaces/factory.h"
 #include "riaecs/include/interfaces/file.h"
 #include "riaecs/include/interfaces/container.h"
+#include "riaecs/include/interfaces/memory.h"
 
 #include <string>
 #include <string_view>
+#include <optional>
+#include <vector>
 
 namespace riaecs
 {
@@ -20,6 +23,23 @@ namespace riaecs
     {
     public:
         virtual ~IAssetStagingArea() = default;
+
+        // Bytes held until Commit, reported to the load profiler
+        virtual size_t GetSize() const { return 0; }
+    };
+
+    // Memory for asset data, staging buffers and file data, taken from IPool through IAllocator.
+    // Reset releases everything in bulk, blocks still in use included, so none of them may be used or freed after
+    class IAssetMemory
+    {
+    public:
+        virtual ~IAssetMemory() = default;
+
+        virtual std::byte *Malloc(size_t size) = 0;
+        virtual void Free(std::byte *ptr) = 0;
+        virtual void Reset() = 0;
+
+        virtual size_t GetUsedSize() const = 0;
     };
 
     class IAssetFactory
@@ -30,6 +50,45 @@ namespace riaecs
         virtual std::unique_ptr<IAssetStagingArea> Prepare() const = 0;
         virtual std::unique_ptr<IAsset> Create(const IFileData &fileData, IAssetStagingArea &stagingArea) const = 0;
         virtual void Commit(IAssetStagingArea &stagingArea) const = 0;
+
+        // Asset source IDs which every asset created by this factory depends on
+        virtual std::vector<size_t> GetDependencies() const { return {}; }
+
+        // Called instead of Prepare and Create when the loader has asset memory for this factory.
+        // Factories which keep their data in asset memory override these
+        virtual std::unique_ptr<IAssetStagingArea> PrepareWithMemory(IAssetMemory &/*memory*/) const
+        {
+            return Prepare();
+        }
+
+        virtual std::unique_ptr<IAsset> CreateWithMemory
+        (
+            const IFileData &fileData, IAssetStagingArea &stagingArea, IAssetMemory &/*memory*/
+        ) const
+        {
+            return Create(fileData, stagingArea);
+        }
+    };
+
+    constexpr size_t DEFAULT_FILE_CHUNK_SIZE = 1024 * 1024;
+    constexpr size_t DEFAULT_MAX_BUFFERED_CHUNK_COUNT = 4;
+
+    // Implemented by asset factories which can decode while the file is read.
+    // Used instead of IAssetFactory::Create when the file loader is also an IFileStreamLoader
+    class IStreamingAssetFactory
+    {
+    public:
+        virtual ~IStreamingAssetFactory() = default;
+
+        virtual std::unique_ptr<IAsset> CreateFromStream
+        (
+            IFileChunkReader &chunkReader, IAssetStagingArea &stagingArea
+        ) const = 0;
+
+        virtual size_t GetChunkSize() const { return DEFAULT_FILE_CHUNK_SIZE; }
+
+        // Bounds the memory read ahead of the decoding
+        virtual size_t GetMaxBufferedChunkCount() const { return DEFAULT_MAX_BUFFERED_CHUNK_COUNT; }
     };
 
     class AssetSource
@@ -38,18 +97,40 @@ namespace riaecs
         std::string filePath;
         size_t fileLoaderID;
         size_t assetFactoryID;
+        std::vector<size_t> dependencies;
+        std::optional<size_t> fileDecoderID;
 
     public:
         AssetSource(std::string path, size_t loaderID, size_t factoryID)
             : filePath(path), fileLoaderID(loaderID), assetFactoryID(factoryID) {}
 
+        // The dependencies are asset source IDs which must be committed before this asset is created
+        AssetSource(std::string path, size_t loaderID, size_t factoryID, std::vector<size_t> dependencyIDs)
+            : filePath(path), fileLoaderID(loaderID), assetFactoryID(factoryID), dependencies(dependencyIDs) {}
+
         std::string_view GetFilePath() const { return filePath; }
         size_t GetFileLoaderID() const { return fileLoaderID; }
         size_t GetAssetFactoryID() const { return assetFactoryID; }
+        const std::vector<size_t> &GetDependencies() const { return dependencies; }
+
+        // The decoder runs between the file loader and the asset factory. Set it before adding the source
+        void SetFileDecoderID(size_t decoderID) { fileDecoderID = decoderID; }
+        const std::optional<size_t> &GetFileDecoderID() const { return fileDecoderID; }
     };
 
     using IAssetFactoryRegistry = IRegistry<IAssetFactory>;
-    using IAssetSourceRegistry = IRegistry<AssetSource>;
+
+    class IAssetSourceRegistry : public IRegistry<AssetSource>
+    {
+    public:
+        virtual ~IAssetSourceRegistry() = default;
+
+        // Find the source registered with the same file path, loader and factory
+        virtual std::optional<size_t> Find(std::string_view filePath, size_t loaderID, size_t factoryID) const = 0;
+
+        // Find the first source registered with the file path
+        virtual std::optional<size_t> Find(std::string_view filePath) const = 0;
+    };
 
     using IAssetContainer = IContainer<IAsset>;
 
@@ -1,6 +1,7 @@
 ﻿#pragma once
 
 #include "riaecs/include/types/id.h"
+#include "riaecs/include/types/entity.h"
 #include "riaecs/include/types/object.h"
 #include "riaecs/include/interfaces/registry.h"
 #include "riaecs/include/interfaces/factory.h"
@@ -9,19 +10,248 @@
 
 #include <memory>
 #include <unordered_set>
+#include <vector>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+#include <new>
+#include <cstring>
 
 namespace riaecs
 {
-    using Entity = ID;
+    using Entity = EntityHandle;
 
-    using IComponentFactory = IFactory<std::byte*, std::byte*>;
+    // Everything the world needs to store a component type, as plain data and function pointers
+    struct ComponentMeta
+    {
+        size_t size = 0;
+        size_t alignment = 0;
+        bool isTriviallyDefaultConstructible = false;
+        bool isTriviallyCopyable = false;
+        bool isTriviallyDestructible = false;
+
+        // Empty trivial types only record membership. They get no pool and are never constructed or destroyed
+        bool isTag = false;
+
+        // Split components describe their hot part here and their cold part in cold, which is stored
+        // in a separate column. Null for other components
+        const ComponentMeta *cold = nullptr;
+
+        // Shared components keep one instance per distinct value, found through hash and equal
+        bool isShared = false;
+        size_t (*hash)(const std::byte *data) = nullptr;
+        bool (*equal)(const std::byte *lhs, const std::byte *rhs) = nullptr;
+
+        // Null if the type cannot be default constructed
+        void (*construct)(std::byte *data) = nullptr;
+        void (*destroy)(std::byte *data) = nullptr;
+
+        // Copy constructs into dst. Null if the type cannot be copied
+        void (*copy)(std::byte *dst, const std::byte *src) = nullptr;
+
+        // Move constructs into dst and destroys src. Null if the type cannot be moved
+        void (*move)(std::byte *dst, std::byte *src) = nullptr;
+
+        // The helpers below take memset, memcpy or nothing for trivial types instead of calling through the pointers
+
+        void Construct(std::byte *data) const
+        {
+            // Value initializing a trivial type zeroes it
+            if (isTriviallyDefaultConstructible)
+                std::memset(data, 0, size);
+            else
+                construct(data);
+        }
+
+        void Destroy(std::byte *data) const
+        {
+            if (!isTriviallyDestructible)
+                destroy(data);
+        }
+
+        void Copy(std::byte *dst, const std::byte *src) const
+        {
+            if (isTriviallyCopyable)
+                std::memcpy(dst, src, size);
+            else
+                copy(dst, src);
+        }
+
+        void Move(std::byte *dst, std::byte *src) const
+        {
+            if (isTriviallyCopyable)
+                std::memcpy(dst, src, size);
+            else
+                move(dst, src);
+        }
+    };
+
+    using ComponentConstructor = void (*)(std::byte *data, void *context);
+    using ComponentModifier = void (*)(std::byte *data, void *context);
+
+    class Prefab;
+
+    using ComponentComparator = std::function<bool
+    (
+        const Entity &lhsEntity, const std::byte *lhs, const Entity &rhsEntity, const std::byte *rhs
+    )>;
+
+    // The packed front of an owning group's storages. Every owned component keeps the group's entities at
+    // positions [0, size) in the same order, so columns[i][n] is the i-th owned component of entities[n].
+    // Columns of tags hold null
+    struct GroupData
+    {
+        size_t size = 0;
+        const Entity *entities = nullptr;
+        std::vector<size_t> componentIDs;
+        std::vector<std::byte *const *> columns;
+    };
+
+    // Entities sharing one instance of a shared component
+    struct SharedGroup
+    {
+        const std::byte *data = nullptr;
+        std::vector<Entity> entities;
+    };
+
+    class IECSWorld;
+
+    // Receives the entities whose component was added or removed since the last flush, one batch per run
+    // of same kind events in the order they happened. Called outside the world lock, so it may use the world. Removed components are already destroyed
+    class IComponentObserver
+    {
+    public:
+        virtual ~IComponentObserver() = default;
+
+        virtual void OnAdd(IECSWorld &world, size_t componentID, const std::vector<Entity> &entities) = 0;
+        virtual void OnRemove(IECSWorld &world, size_t componentID, const std::vector<Entity> &entities) = 0;
+    };
+
+    // A component declaring nested Hot and Cold types is split. The world stores the parts in separate
+    // columns under one component ID, and the typed accessors only touch the hot part unless the cold
+    // part is asked for
+    template <typename T, typename = void>
+    struct ComponentParts
+    {
+        static constexpr bool IS_SPLIT = false;
+        using Hot = T;
+    };
+
+    template <typename T>
+    struct ComponentParts<T, std::void_t<typename T::Hot, typename T::Cold>>
+    {
+        static constexpr bool IS_SPLIT = true;
+        using Hot = typename T::Hot;
+        using Cold = typename T::Cold;
+    };
+
+    // A component declaring static constexpr bool IS_SHARED = true is shared. Entities with equal values
+    // reference one instance, so the type needs operator== and a std::hash specialization. Its max count
+    // is the number of distinct values rather than entities, as only the instances take pool blocks
+    template <typename T, typename = void>
+    struct IsSharedComponent : std::false_type {};
+
+    template <typename T>
+    struct IsSharedComponent<T, std::enable_if_t<T::IS_SHARED>> : std::true_type {};
+
+    template <typename T>
+    using ComponentHot = typename ComponentParts<T>::Hot;
+
+    template <typename T>
+    using ComponentCold = typename ComponentParts<T>::Cold;
+
+    // The meta of a single stored type, either a whole component or one part of a split component
+    template <typename T>
+    constexpr ComponentMeta MakeComponentPartMeta()
+    {
+        ComponentMeta meta;
+        meta.size = sizeof(T);
+        meta.alignment = alignof(T);
+        meta.isTriviallyDefaultConstructible = std::is_trivially_default_constructible_v<T>;
+        meta.isTriviallyCopyable = std::is_trivially_copyable_v<T>;
+        meta.isTriviallyDestructible = std::is_trivially_destructible_v<T>;
+        meta.isTag = std::is_empty_v<T> && meta.isTriviallyDefaultConstructible && meta.isTriviallyDestructible;
+
+        // Types without a default constructor can only be added by emplacing them
+        if constexpr (std::is_default_constructible_v<T>)
+            meta.construct = [](std::byte *data) { new(data) T(); };
+
+        meta.destroy = [](std::byte *data) { reinterpret_cast<T*>(data)->~T(); };
+
+        if constexpr (std::is_copy_constructible_v<T>)
+        {
+            meta.copy = [](std::byte *dst, const std::byte *src)
+            {
+                new(dst) T(*reinterpret_cast<const T*>(src));
+            };
+        }
+
+        if constexpr (std::is_move_constructible_v<T>)
+        {
+            meta.move = [](std::byte *dst, std::byte *src)
+            {
+                T *srcComponent = reinterpret_cast<T*>(src);
+                new(dst) T(std::move(*srcComponent));
+                srcComponent->~T();
+            };
+        }
+
+        return meta;
+    }
+
+    template <typename T>
+    inline constexpr ComponentMeta COMPONENT_PART_META = MakeComponentPartMeta<T>();
+
+    template <typename T>
+    constexpr ComponentMeta MakeComponentMeta()
+    {
+        if constexpr (ComponentParts<T>::IS_SPLIT)
+        {
+            using Hot = typename ComponentParts<T>::Hot;
+            using Cold = typename ComponentParts<T>::Cold;
+            static_assert(!std::is_empty_v<Hot> && !std::is_empty_v<Cold>, "Split parts must hold data");
+            static_assert(std::is_default_constructible_v<Cold>, "The cold part is default constructed when added");
+
+            static_assert(!IsSharedComponent<T>::value, "Split components cannot be shared");
+
+            ComponentMeta meta = MakeComponentPartMeta<Hot>();
+            meta.cold = &COMPONENT_PART_META<Cold>;
+            return meta;
+        }
+        else
+        {
+            ComponentMeta meta = MakeComponentPartMeta<T>();
+            if constexpr (IsSharedComponent<T>::value)
+            {
+                static_assert(!std::is_empty_v<T>, "Shared components must hold data");
+                static_assert(std::is_copy_constructible_v<T>, "Shared components are copied on write");
+
+                meta.isShared = true;
+                meta.hash = [](const std::byte *data)
+                {
+                    return std::hash<T>()(*reinterpret_cast<const T*>(data));
+                };
+                meta.equal = [](const std::byte *lhs, const std::byte *rhs)
+                {
+                    return *reinterpret_cast<const T*>(lhs) == *reinterpret_cast<const T*>(rhs);
+                };
+            }
+
+            return meta;
+        }
+    }
+
+    class IComponentFactory : public IFactory<std::byte*, std::byte*>
+    {
+    public:
+        virtual ~IComponentFactory() = default;
+        virtual const ComponentMeta &GetMeta() const = 0;
+    };
     using IComponentFactoryRegistry = IRegistry<IComponentFactory>;
 
     using IComponentMaxCountRegistry = IRegistry<size_t>;
 
-    using IPoolFactory = IFactory<std::unique_ptr<IPool>, size_t>;
-    using IAllocatorFactory = IFactory<std::unique_ptr<IAllocator>, IPool&, size_t>;
-
     class IECSWorld
     {
     public:
@@ -39,24 +269,121 @@ namespace riaecs
         virtual Entity CreateEntity() = 0;
         virtual void DestroyEntity(const Entity &entity) = 0;
 
+        // Batch versions which take the lock once. CreateEntities appends the new entities to out,
+        // each with default constructed componentIDs
+        virtual void CreateEntities(size_t count, const std::vector<size_t> &componentIDs, std::vector<Entity> &out) = 0;
+        virtual void DestroyEntities(const std::vector<Entity> &entities) = 0;
+
+        // Destroys every entity but keeps the world ready, resetting the pools instead of freeing each block
+        virtual void Clear() = 0;
+
+        // Observers are not owned and must be removed before they are destroyed. Events are queued while
+        // structural changes are applied and delivered by FlushObservers, which the system loop calls after
+        // each system update
+        virtual void AddComponentObserver(size_t componentID, IComponentObserver &observer) = 0;
+        virtual void RemoveComponentObserver(size_t componentID, IComponentObserver &observer) = 0;
+        virtual void FlushObservers() = 0;
+
+        // Captures the component set and values of a template entity. The entity can be destroyed afterwards
+        virtual Prefab CreatePrefab(const Entity &entity) const = 0;
+
+        // Creates count entities holding copies of the prefab's components and appends them to out
+        virtual void Instantiate(const Prefab &prefab, size_t count, std::vector<Entity> &out) = 0;
+
         virtual void RegisterEntity(size_t index, const Entity &entity) = 0;
         virtual Entity GetRegisteredEntity(size_t index) const = 0;
 
         virtual void AddComponent(const Entity &entity, size_t componentID) = 0;
+
+        // Constructs the component directly in its pool block by calling constructor(data, context)
+        // instead of default constructing it
+        virtual void AddComponent
+        (
+            const Entity &entity, size_t componentID, ComponentConstructor constructor, void *context
+        ) = 0;
+
         virtual void RemoveComponent(const Entity &entity, size_t componentID) = 0;
         virtual bool HasComponent(const Entity &entity, size_t componentID) const = 0;
-        virtual ReadOnlyObject<std::byte*> GetComponent(const Entity &entity, size_t componentID) = 0;
+        // Returns nullptr for tag components, which have no data. Use GetMutableComponent to write, or
+        // ModifySharedComponent for shared components
+        virtual ReadOnlyObject<const std::byte*> GetComponent(const Entity &entity, size_t componentID) = 0;
+
+        // Same as GetComponent but stamps the component as changed at the current tick. Shared components
+        // are read only here, they are changed through ModifySharedComponent
+        virtual ReadOnlyObject<std::byte*> GetMutableComponent(const Entity &entity, size_t componentID) = 0;
+
+        // The cold part of a split component, which GetComponent leaves out
+        virtual ReadOnlyObject<const std::byte*> GetColdComponent(const Entity &entity, size_t componentID) = 0;
+        virtual ReadOnlyObject<std::byte*> GetMutableColdComponent(const Entity &entity, size_t componentID) = 0;
+
+        // The system loop advances the tick before each system update. A system keeps the tick it ran at
+        // and passes it as sinceTick next time to get only the components added or changed after that
+        virtual uint64_t GetTick() const = 0;
+        virtual uint64_t AdvanceTick() = 0;
+        virtual std::vector<Entity> Added(size_t componentID, uint64_t sinceTick) const = 0;
+        virtual std::vector<Entity> Changed(size_t componentID, uint64_t sinceTick) const = 0;
+
+        // Sorts each component's storage by entity index and moves the components, hot and cold, around
+        // inside the blocks they already own so addresses ascend in that order. Component pointers taken
+        // before are invalidated. The budgeted version stops once the budget runs out, even inside one
+        // component, continues from there next call and returns true once every component is compacted
+        virtual void Compact() = 0;
+        virtual bool Compact(std::chrono::microseconds budget) = 0;
+
+        // Sorts the component's storage and its blocks so View and memory follow the order. The comparator
+        // runs under the world lock and gets null data for tags. Compact puts entity order back
+        virtual void SortComponent(size_t componentID, const ComponentComparator &less) = 0;
+
+        // Orders the entities shared with the leader first, in the leader's order, followed by the rest
+        virtual void SortComponentLike(size_t componentID, size_t leaderComponentID) = 0;
+
+        // Makes the world keep the entities having all of ownedComponentIDs packed at the front of each
+        // owned storage, in the same order. A component can be owned by one group only and owned
+        // components cannot be sorted. Returns the group ID
+        virtual size_t CreateGroup(const std::vector<size_t> &ownedComponentIDs) = 0;
+        virtual ReadOnlyObject<GroupData> GetGroup(size_t groupID) const = 0;
 
-        virtual ReadOnlyObject<std::unordered_set<Entity>> View(size_t componentID) const = 0;
+        // Same as GetGroup but stamps the owned components of every member as changed at the current tick
+        virtual ReadOnlyObject<GroupData> GetMutableGroup(size_t groupID) = 0;
+
+        // Runs modifier(data, context) on the entity's own copy of a shared component and shares the result
+        // again, so the other entities keep the old value
+        virtual void ModifySharedComponent
+        (
+            const Entity &entity, size_t componentID, ComponentModifier modifier, void *context
+        ) = 0;
+
+        // The entities of a shared component grouped by the instance they reference, so work depending only
+        // on the value can run once per group. The data stays valid until the next structural change
+        virtual std::vector<SharedGroup> GroupByShared(size_t componentID) const = 0;
+
+        // The entities in the component's dense storage order
+        virtual ReadOnlyObject<std::vector<Entity>> View(size_t componentID) const = 0;
+
+        // Entities which have all of includeIDs and none of excludeIDs
+        virtual std::vector<Entity> Query
+        (
+            const std::vector<size_t> &includeIDs, const std::vector<size_t> &excludeIDs = {}
+        ) const = 0;
+
+        // Available after CreateWorld
+        virtual const ComponentMeta &GetComponentMeta(size_t componentID) const = 0;
     };
 
+    // Read only, see IECSWorld::GetComponent
     template <typename T>
-    ReadOnlyObject<T*> GetComponent(IECSWorld &world, const Entity &entity, size_t componentID)
+    ReadOnlyObject<const T*> GetComponent(IECSWorld &world, const Entity &entity, size_t componentID)
     {
-        ReadOnlyObject<std::byte*> componentData = world.GetComponent(entity, componentID);
-        if (componentData() == nullptr)
-            return ReadOnlyObject<T*>(std::move(componentData.TakeLock()), nullptr);
+        ReadOnlyObject<const std::byte*> componentData = world.GetComponent(entity, componentID);
+        const T* data = reinterpret_cast<const T*>(componentData());
+        return ReadOnlyObject<const T*>(std::move(componentData.TakeLock()), data);
+    }
 
+    // Stamps the component as changed, see IECSWorld::GetMutableComponent
+    template <typename T>
+    ReadOnlyObject<T*> GetMutableComponent(IECSWorld &world, const Entity &entity, size_t componentID)
+    {
+        ReadOnlyObject<std::byte*> componentData = world.GetMutableComponent(entity, componentID);
         T* data = reinterpret_cast<T*>(componentData());
         return ReadOnlyObject<T*>(std::move(componentData.TakeLock()), data);
     }
@@ -5,6 +5,7 @@
 
 #include <memory>
 #include <string_view>
+#include <cstddef>
 
 namespace riaecs
 {
@@ -17,4 +18,48 @@ namespace riaecs
     using IFileLoader = ILoader<std::unique_ptr<IFileData>, std::string_view>;
     using IFileLoaderRegistry = IRegistry<IFileLoader>;
 
+    // Transforms the loaded file data before it reaches the asset factory, e.g. decompression.
+    // Called on the thread running the load
+    class IFileDecoder
+    {
+    public:
+        virtual ~IFileDecoder() = default;
+        virtual std::unique_ptr<IFileData> Decode(const IFileData &fileData) const = 0;
+    };
+    using IFileDecoderRegistry = IRegistry<IFileDecoder>;
+
+    class IFileStream
+    {
+    public:
+        virtual ~IFileStream() = default;
+
+        virtual size_t GetSize() const = 0;
+
+        // Read up to size bytes from the offset. Returns the number of bytes read
+        virtual size_t Read(size_t offset, std::byte *buffer, size_t size) = 0;
+    };
+
+    // Implemented by file loaders which can also open a file without reading all of it
+    class IFileStreamLoader
+    {
+    public:
+        virtual ~IFileStreamLoader() = default;
+        virtual std::unique_ptr<IFileStream> Open(std::string_view filePath) const = 0;
+    };
+
+    class IFileChunkReader
+    {
+    public:
+        virtual ~IFileChunkReader() = default;
+
+        virtual size_t GetSize() const = 0;
+
+        // Get the next chunk in file order. Returns false at the end of the file.
+        // The chunk stays valid until the next call
+        virtual bool Next(const std::byte *&data, size_t &size) = 0;
+
+        // Read an arbitrary byte range. Returns the number of bytes read
+        virtual size_t ReadRange(size_t offset, std::byte *buffer, size_t size) = 0;
+    };
+
 } // namespace riaecs
\ No newline at end of file
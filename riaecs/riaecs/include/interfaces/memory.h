@@ -1,5 +1,10 @@
 ﻿#pragma once
 
+#include "riaecs/include/interfaces/factory.h"
+
+#include <memory>
+#include <cstddef>
+
 namespace riaecs
 {
     constexpr size_t MAX_FREE_BLOCK_SIZE = sizeof(void*) * 4;
@@ -22,4 +27,7 @@ namespace riaecs
         virtual void Free(std::byte *ptr, IPool &pool) = 0;
     };
 
+    using IPoolFactory = IFactory<std::unique_ptr<IPool>, size_t>;
+    using IAllocatorFactory = IFactory<std::unique_ptr<IAllocator>, IPool&, size_t>;
+
 } // namespace riaecs
\ No newline at end of file
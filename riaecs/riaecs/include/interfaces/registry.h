@@ -16,6 +16,10 @@ namespace riaecs
         virtual ReadOnlyObject<T> Get(size_t id) const = 0;
 
         virtual size_t GetCount() const = 0;
+
+        // Make the registry immutable. Lookups stop taking the lock and Add is rejected
+        virtual void Freeze() = 0;
+        virtual bool IsFrozen() const = 0;
     };
 
 } // namespace riaecs
\ No newline at end of file
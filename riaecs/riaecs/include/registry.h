@@ -5,6 +5,7 @@
 
 #include <unordered_map>
 #include <shared_mutex>
+#include <atomic>
 
 namespace riaecs
 {
@@ -15,6 +16,17 @@ namespace riaecs
         std::vector<std::unique_ptr<T>> factories_;
         mutable std::shared_mutex mutex_;
 
+        // Once set, factories_ never changes again, so readers skip the mutex
+        std::atomic<bool> isFrozen_ = false;
+
+        std::shared_lock<std::shared_mutex> LockIfNotFrozen() const
+        {
+            if (isFrozen_.load(std::memory_order_acquire))
+                return std::shared_lock<std::shared_mutex>();
+
+            return std::shared_lock<std::shared_mutex>(mutex_);
+        }
+
     public:
         Registry() = default;
         virtual ~Registry() = default;
@@ -26,6 +38,9 @@ namespace riaecs
         {
             std::unique_lock<std::shared_mutex> lock(mutex_);
 
+            if (isFrozen_.load(std::memory_order_relaxed))
+                NotifyError({"Cannot add to a frozen registry"}, __FILE__, __LINE__, __FUNCTION__);
+
             if (!entry)
                 NotifyError({"Entry cannot be null"}, __FILE__, __LINE__, __FUNCTION__);
 
@@ -37,7 +52,7 @@ namespace riaecs
 
         ReadOnlyObject<T> Get(size_t id) const override
         {
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
 
             if (id >= factories_.size())
                 NotifyError({"ID out of range: ", std::to_string(id)}, __FILE__, __LINE__, __FUNCTION__);
@@ -50,9 +65,20 @@ namespace riaecs
 
         virtual size_t GetCount() const override
         {
-            std::shared_lock<std::shared_mutex> lock(mutex_);
+            std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
             return factories_.size();
         }
+
+        void Freeze() override
+        {
+            std::unique_lock<std::shared_mutex> lock(mutex_);
+            isFrozen_.store(true, std::memory_order_release);
+        }
+
+        bool IsFrozen() const override
+        {
+            return isFrozen_.load(std::memory_order_acquire);
+        }
     };
 
 } // namespace riaecs
\ No newline at end of file
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "riaecs/include/dll_config.h"
+
+#include <vector>
+#include <queue>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace riaecs
+{
+    class RIAECS_API ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers_;
+        std::queue<std::function<void()>> tasks_;
+        size_t runningCount_ = 0;
+        bool isStopping_ = false;
+
+        std::mutex mutex_;
+        std::condition_variable taskCondition_;
+        std::condition_variable idleCondition_;
+
+        void WorkerLoop();
+
+    public:
+        // If threadCount is 0, the hardware concurrency is used
+        explicit ThreadPool(size_t threadCount = 0);
+        virtual ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Tasks must not throw. Queued tasks are still run when the pool is destroyed
+        void Submit(std::function<void()> task);
+
+        // Block until the queue is empty and no task is running
+        void WaitIdle();
+
+        size_t GetThreadCount() const { return workers_.size(); }
+    };
+
+} // namespace riaecs
\ No newline at end of file
@@ -0,0 +1,58 @@
+﻿#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+
+// Bits of the 64-bit entity handle used for the index, the rest hold the generation
+#ifndef RIAECS_ENTITY_INDEX_BITS
+#define RIAECS_ENTITY_INDEX_BITS 32
+#endif
+
+namespace riaecs
+{
+    constexpr uint64_t ENTITY_INDEX_BITS = RIAECS_ENTITY_INDEX_BITS;
+    constexpr uint64_t ENTITY_GENERATION_BITS = 64 - ENTITY_INDEX_BITS;
+    static_assert(ENTITY_INDEX_BITS > 0 && ENTITY_INDEX_BITS < 64, "Entity handle needs index and generation bits");
+
+    constexpr uint64_t ENTITY_INDEX_MASK = (uint64_t(1) << ENTITY_INDEX_BITS) - 1;
+    constexpr uint64_t ENTITY_GENERATION_MASK = (uint64_t(1) << ENTITY_GENERATION_BITS) - 1;
+
+    // The largest index is reserved as the end of the world's free slot list
+    constexpr size_t ENTITY_NULL_INDEX = static_cast<size_t>(ENTITY_INDEX_MASK);
+    constexpr size_t ENTITY_MAX_INDEX = ENTITY_NULL_INDEX - 1;
+
+    // Index and generation packed into one 64-bit value. Generations wrap around
+    class EntityHandle
+    {
+    private:
+        uint64_t value_ = 0;
+
+    public:
+        constexpr EntityHandle(size_t index, size_t generation)
+        : value_((uint64_t(generation) & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS | (uint64_t(index) & ENTITY_INDEX_MASK)) {}
+        EntityHandle() = default;
+        ~EntityHandle() = default;
+
+        size_t GetIndex() const { return static_cast<size_t>(value_ & ENTITY_INDEX_MASK); }
+        size_t GetGeneration() const { return static_cast<size_t>(value_ >> ENTITY_INDEX_BITS); }
+        uint64_t GetValue() const { return value_; }
+
+        bool operator==(const EntityHandle &other) const { return value_ == other.value_; }
+        bool operator!=(const EntityHandle &other) const { return value_ != other.value_; }
+    };
+    static_assert(sizeof(EntityHandle) == sizeof(uint64_t), "Entity handle must stay 64 bits");
+
+} // namespace riaecs
+
+namespace std 
+{
+    template <>
+    struct hash<riaecs::EntityHandle> 
+    {
+        std::size_t operator()(const riaecs::EntityHandle &entity) const noexcept 
+        {
+            return std::hash<uint64_t>()(entity.GetValue());
+        }
+    };
+}
\ No newline at end of file
@@ -18,6 +18,7 @@
 /**********************************************************************************************************************/
 
 #include "riaecs/include/types/id.h"
+#include "riaecs/include/types/entity.h"
 #include "riaecs/include/types/object.h"
 #include "riaecs/include/types/stl_hash.h"
 #include "riaecs/include/types/stl_euqal.h"
@@ -27,10 +28,16 @@
 /**********************************************************************************************************************/
 
 #include "riaecs/include/asset.h"
+#include "riaecs/include/asset_loader.h"
+#include "riaecs/include/asset_memory.h"
+#include "riaecs/include/asset_profiler.h"
+#include "riaecs/include/asset_watcher.h"
+#include "riaecs/include/compression.h"
 #include "riaecs/include/container.h"
 #include "riaecs/include/ecs.h"
 #include "riaecs/include/file.h"
 #include "riaecs/include/global_registry.h"
 #include "riaecs/include/log.h"
 #include "riaecs/include/registry.h"
+#include "riaecs/include/thread_pool.h"
 #include "riaecs/include/utilities.h"
\ No newline at end of file
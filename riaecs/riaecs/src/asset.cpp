@@ -0,0 +1,242 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/asset.h"
+
+#include "riaecs/include/utilities.h"
+
+std::shared_lock<std::shared_mutex> riaecs::AssetSourceRegistry::LockIfNotFrozen() const
+{
+    if (isFrozen_.load(std::memory_order_acquire))
+        return std::shared_lock<std::shared_mutex>();
+
+    return std::shared_lock<std::shared_mutex>(mutex_);
+}
+
+size_t riaecs::AssetSourceRegistry::Add(std::unique_ptr<AssetSource> entry)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (isFrozen_.load(std::memory_order_relaxed))
+        riaecs::NotifyError({"Cannot add to a frozen registry"}, RIAECS_LOG_LOC);
+
+    if (!entry)
+        riaecs::NotifyError({"Entry cannot be null"}, RIAECS_LOG_LOC);
+
+    SourceKey key{std::string(entry->GetFilePath()), entry->GetFileLoaderID(), entry->GetAssetFactoryID()};
+
+    // Return the existing source instead of registering the same file twice
+    auto it = sourceIndex_.find(key);
+    if (it != sourceIndex_.end())
+    {
+        if (sources_[it->second]->GetFileDecoderID() != entry->GetFileDecoderID())
+        {
+            riaecs::NotifyError
+            (
+                {"Source is already registered with a different file decoder: ", key.filePath}, RIAECS_LOG_LOC
+            );
+        }
+
+        if (sources_[it->second]->GetDependencies() != entry->GetDependencies())
+        {
+            riaecs::NotifyError
+            (
+                {"Source is already registered with different dependencies: ", key.filePath}, RIAECS_LOG_LOC
+            );
+        }
+
+        return it->second;
+    }
+
+    size_t id = sources_.size();
+    sources_.emplace_back(std::move(entry));
+
+    pathIndex_.emplace(key.filePath, id);
+    sourceIndex_.emplace(std::move(key), id);
+
+    return id;
+}
+
+riaecs::ReadOnlyObject<riaecs::AssetSource> riaecs::AssetSourceRegistry::Get(size_t id) const
+{
+    std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
+
+    if (id >= sources_.size())
+        riaecs::NotifyError({"ID out of range: ", std::to_string(id)}, RIAECS_LOG_LOC);
+
+    return riaecs::ReadOnlyObject<riaecs::AssetSource>(std::move(lock), *sources_[id]);
+}
+
+size_t riaecs::AssetSourceRegistry::GetCount() const
+{
+    std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
+    return sources_.size();
+}
+
+std::optional<size_t> riaecs::AssetSourceRegistry::Find
+(
+    std::string_view filePath, size_t loaderID, size_t factoryID
+) const
+{
+    std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
+
+    auto it = sourceIndex_.find(SourceKey{std::string(filePath), loaderID, factoryID});
+    if (it == sourceIndex_.end())
+        return std::nullopt;
+
+    return it->second;
+}
+
+std::optional<size_t> riaecs::AssetSourceRegistry::Find(std::string_view filePath) const
+{
+    std::shared_lock<std::shared_mutex> lock = LockIfNotFrozen();
+
+    auto it = pathIndex_.find(std::string(filePath));
+    if (it == pathIndex_.end())
+        return std::nullopt;
+
+    return it->second;
+}
+
+void riaecs::AssetSourceRegistry::Freeze()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    isFrozen_.store(true, std::memory_order_release);
+}
+
+bool riaecs::AssetSourceRegistry::IsFrozen() const
+{
+    return isFrozen_.load(std::memory_order_acquire);
+}
+
+void riaecs::AssetReferenceTable::AddRef(const ID &id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refCounts_[id]++;
+}
+
+bool riaecs::AssetReferenceTable::TryAddRef(const ID &id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = refCounts_.find(id);
+    if (it == refCounts_.end())
+        return false; // Already collected
+
+    it->second++;
+    return true;
+}
+
+void riaecs::AssetReferenceTable::Release(const ID &id)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = refCounts_.find(id);
+    if (it == refCounts_.end() || it->second == 0)
+        riaecs::NotifyError({"Asset reference released more than acquired: " + std::to_string(id.GetIndex())}, RIAECS_LOG_LOC);
+
+    it->second--;
+
+    // Schedule the asset for unload at the next collection
+    if (it->second == 0)
+        unreferenced_.push_back(id);
+}
+
+size_t riaecs::AssetReferenceTable::GetRefCount(const ID &id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = refCounts_.find(id);
+    if (it == refCounts_.end())
+        return 0;
+
+    return it->second;
+}
+
+std::vector<std::unique_ptr<riaecs::IAsset>> riaecs::AssetReferenceTable::CollectUnreferenced
+(
+    IAssetContainer &container
+){
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::unique_ptr<IAsset>> assets;
+    for (const ID &id : unreferenced_)
+    {
+        auto it = refCounts_.find(id);
+        if (it == refCounts_.end() || it->second != 0)
+            continue; // Already collected or referenced again
+
+        refCounts_.erase(it);
+
+        if (container.Contains(id))
+            assets.emplace_back(container.Erase(id));
+    }
+    unreferenced_.clear();
+
+    return assets;
+}
+
+riaecs::AssetUnloader::AssetUnloader()
+{
+    worker_ = std::thread(&AssetUnloader::WorkerLoop, this);
+}
+
+riaecs::AssetUnloader::~AssetUnloader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopping_ = true;
+    }
+    pendingCondition_.notify_all();
+
+    if (worker_.joinable())
+        worker_.join();
+}
+
+void riaecs::AssetUnloader::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        pendingCondition_.wait(lock, [this]() { return isStopping_ || !pendingAssets_.empty(); });
+
+        // Destroy the remaining assets even when stopping
+        if (pendingAssets_.empty() && isStopping_)
+            break;
+
+        std::vector<std::unique_ptr<IAsset>> assets = std::move(pendingAssets_);
+        pendingAssets_.clear();
+        destroyingCount_ = assets.size();
+
+        // Destroy assets without holding the lock
+        lock.unlock();
+        assets.clear();
+        lock.lock();
+
+        destroyingCount_ = 0;
+        if (pendingAssets_.empty())
+            idleCondition_.notify_all();
+    }
+}
+
+size_t riaecs::AssetUnloader::Unload(IAssetContainer &container, AssetReferenceTable &table)
+{
+    std::vector<std::unique_ptr<IAsset>> assets = table.CollectUnreferenced(container);
+    size_t count = assets.size();
+    if (count == 0)
+        return 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::unique_ptr<IAsset> &asset : assets)
+            pendingAssets_.emplace_back(std::move(asset));
+    }
+    pendingCondition_.notify_one();
+
+    return count;
+}
+
+void riaecs::AssetUnloader::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return pendingAssets_.empty() && destroyingCount_ == 0; });
+}
\ No newline at end of file
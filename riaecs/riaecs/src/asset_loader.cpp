@@ -0,0 +1,718 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/asset_loader.h"
+
+#include "riaecs/include/file.h"
+
+#include "riaecs/include/utilities.h"
+
+namespace
+{
+    // Passed to the threads joining a load which was cancelled by its owner
+    class AssetLoadCancelledError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    const std::atomic<bool> NOT_CANCELLED = false;
+
+} // namespace
+
+riaecs::AssetLoader::AssetLoader
+(
+    const IAssetSourceRegistry &sourceRegistry, const IFileLoaderRegistry &fileLoaderRegistry,
+    const IAssetFactoryRegistry &assetFactoryRegistry,
+    IAssetContainer &container, AssetReferenceTable &referenceTable
+) : 
+    sourceRegistry_(sourceRegistry), fileLoaderRegistry_(fileLoaderRegistry), 
+    assetFactoryRegistry_(assetFactoryRegistry), 
+    container_(container), referenceTable_(referenceTable)
+{
+}
+
+riaecs::AssetLoader::AssetLoader
+(
+    const IAssetSourceRegistry &sourceRegistry, const IFileLoaderRegistry &fileLoaderRegistry,
+    const IFileDecoderRegistry &fileDecoderRegistry, const IAssetFactoryRegistry &assetFactoryRegistry,
+    IAssetContainer &container, AssetReferenceTable &referenceTable
+) : 
+    AssetLoader(sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, container, referenceTable)
+{
+    fileDecoderRegistry_ = &fileDecoderRegistry;
+}
+
+void riaecs::AssetLoader::SetAssetMemory(IAssetMemory &memory)
+{
+    assetMemory_ = &memory;
+}
+
+void riaecs::AssetLoader::SetAssetMemory(size_t assetFactoryID, IAssetMemory &memory)
+{
+    factoryAssetMemories_[assetFactoryID] = &memory;
+}
+
+std::unique_ptr<riaecs::IAsset> riaecs::AssetLoader::RunStages
+(
+    size_t sourceID, const std::atomic<bool> &isCancelled
+) const
+{
+    riaecs::ReadOnlyObject<riaecs::AssetSource> source = sourceRegistry_.Get(sourceID);
+    riaecs::ReadOnlyObject<riaecs::IFileLoader> fileLoader = fileLoaderRegistry_.Get(source().GetFileLoaderID());
+    riaecs::ReadOnlyObject<riaecs::IAssetFactory> assetFactory = assetFactoryRegistry_.Get(source().GetAssetFactoryID());
+
+    if (isCancelled)
+        return nullptr;
+
+    std::unique_ptr<riaecs::IAssetStagingArea> stagingArea = nullptr;
+    std::unique_ptr<riaecs::IAsset> asset = nullptr;
+    size_t bytesRead = 0;
+
+    // Records the time since the previous stage ended
+    size_t factoryID = source().GetAssetFactoryID();
+    riaecs::AssetLoadProfiler::Clock::time_point stageStart = riaecs::AssetLoadProfiler::Clock::now();
+    auto endStage = [&](riaecs::AssetLoadStage stage)
+    {
+        if (!profiler_)
+            return;
+
+        riaecs::AssetLoadProfiler::Clock::time_point stageEnd = riaecs::AssetLoadProfiler::Clock::now();
+        profiler_->RecordStage(sourceID, factoryID, stage, stageStart, stageEnd);
+        stageStart = stageEnd;
+    };
+
+    const riaecs::IFileStreamLoader *streamLoader = dynamic_cast<const riaecs::IFileStreamLoader*>(&fileLoader());
+    const riaecs::IStreamingAssetFactory *streamingFactory 
+    = dynamic_cast<const riaecs::IStreamingAssetFactory*>(&assetFactory());
+
+    // Decoded sources need the whole file, so they always take the whole file path
+    const std::optional<size_t> &fileDecoderID = source().GetFileDecoderID();
+    if (fileDecoderID && !fileDecoderRegistry_)
+        riaecs::NotifyError({"No file decoder registry for source: " + std::to_string(sourceID)}, RIAECS_LOG_LOC);
+
+    // Use the memory dedicated to the factory, then the shared one
+    riaecs::IAssetMemory *memory = assetMemory_;
+    auto memoryIt = factoryAssetMemories_.find(factoryID);
+    if (memoryIt != factoryAssetMemories_.end())
+        memory = memoryIt->second;
+
+    if (streamLoader && streamingFactory && !fileDecoderID)
+    {
+        // Decode while the file is read ahead in bounded chunks
+        std::unique_ptr<riaecs::IFileStream> stream = streamLoader->Open(source().GetFilePath());
+        if (!stream)
+            riaecs::NotifyError({"Failed to open file: " + std::string(source().GetFilePath())}, RIAECS_LOG_LOC);
+
+        bytesRead = stream->GetSize();
+        riaecs::FileChunkReader chunkReader
+        (
+            std::move(stream), streamingFactory->GetChunkSize(), streamingFactory->GetMaxBufferedChunkCount()
+        );
+        endStage(riaecs::AssetLoadStage::Load);
+
+        stagingArea = memory ? assetFactory().PrepareWithMemory(*memory) : assetFactory().Prepare();
+        endStage(riaecs::AssetLoadStage::Prepare);
+
+        // Reading overlaps with creating, so the stream time is part of Create
+        asset = streamingFactory->CreateFromStream(chunkReader, *stagingArea);
+        endStage(riaecs::AssetLoadStage::Create);
+    }
+    else
+    {
+        std::unique_ptr<riaecs::IFileData> fileData = fileLoader().Load(source().GetFilePath());
+        if (!fileData)
+            riaecs::NotifyError({"Failed to load file: " + std::string(source().GetFilePath())}, RIAECS_LOG_LOC);
+
+        if (const riaecs::MemoryFileData *memoryData = dynamic_cast<const riaecs::MemoryFileData*>(fileData.get()))
+            bytesRead = memoryData->GetSize();
+
+        endStage(riaecs::AssetLoadStage::Load);
+
+        if (isCancelled)
+            return nullptr;
+
+        if (fileDecoderID)
+        {
+            riaecs::ReadOnlyObject<riaecs::IFileDecoder> fileDecoder = fileDecoderRegistry_->Get(*fileDecoderID);
+            fileData = fileDecoder().Decode(*fileData);
+            if (!fileData)
+                riaecs::NotifyError({"Failed to decode file: " + std::string(source().GetFilePath())}, RIAECS_LOG_LOC);
+
+            endStage(riaecs::AssetLoadStage::Decode);
+
+            if (isCancelled)
+                return nullptr;
+        }
+
+        stagingArea = memory ? assetFactory().PrepareWithMemory(*memory) : assetFactory().Prepare();
+        endStage(riaecs::AssetLoadStage::Prepare);
+
+        if (memory)
+            asset = assetFactory().CreateWithMemory(*fileData, *stagingArea, *memory);
+        else
+            asset = assetFactory().Create(*fileData, *stagingArea);
+
+        endStage(riaecs::AssetLoadStage::Create);
+    }
+
+    if (isCancelled)
+        return nullptr;
+
+    size_t stagingSize = stagingArea->GetSize();
+    assetFactory().Commit(*stagingArea);
+    endStage(riaecs::AssetLoadStage::Commit);
+
+    if (!asset)
+        riaecs::NotifyError({"Failed to create asset: " + std::string(source().GetFilePath())}, RIAECS_LOG_LOC);
+
+    if (profiler_)
+        profiler_->RecordLoad(sourceID, factoryID, source().GetFilePath(), bytesRead, stagingSize);
+
+    return asset;
+}
+
+riaecs::ID riaecs::AssetLoader::Acquire(size_t sourceID)
+{
+    ID assetID;
+    TryAcquire(sourceID, NOT_CANCELLED, assetID);
+    return assetID;
+}
+
+bool riaecs::AssetLoader::TryAcquire(size_t sourceID, const std::atomic<bool> &isCancelled, ID &assetID)
+{
+    std::promise<ID> promise;
+    while (true)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        // Return the live asset if it has not been collected yet
+        auto loadedIt = loadedAssets_.find(sourceID);
+        if (loadedIt != loadedAssets_.end())
+        {
+            if (referenceTable_.TryAddRef(loadedIt->second))
+            {
+                assetID = loadedIt->second;
+                return true;
+            }
+
+            loadedAssets_.erase(loadedIt);
+        }
+
+        // Join the in-flight load
+        auto loadingIt = loadingAssets_.find(sourceID);
+        if (loadingIt != loadingAssets_.end())
+        {
+            std::shared_future<ID> loading = loadingIt->second;
+            if (&isCancelled != &NOT_CANCELLED)
+            {
+                // Finished loads leave loadingAssets_ and notify, NotifyCancelled wakes us for the flag
+                loadCondition_.wait(lock, [this, sourceID, &isCancelled, &loading]()
+                {
+                    return isCancelled || loadingAssets_.find(sourceID) == loadingAssets_.end()
+                    || loading.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                });
+
+                if (isCancelled)
+                    return false;
+            }
+            lock.unlock();
+            loading.wait();
+
+            try
+            {
+                assetID = loading.get();
+            }
+            catch (const AssetLoadCancelledError&)
+            {
+                continue; // The owner cancelled the load, load it again
+            }
+
+            if (referenceTable_.TryAddRef(assetID))
+                return true;
+
+            continue; // Collected before we could reference it, look up again
+        }
+
+        loadingAssets_.emplace(sourceID, promise.get_future().share());
+        break;
+    }
+
+    // Load the asset without holding the lock. Anything thrown before it is published must reach the
+    // joiners through the promise
+    bool isAdded = false;
+    try
+    {
+        std::unique_ptr<IAsset> asset = RunStages(sourceID, isCancelled);
+        if (asset)
+        {
+            assetID = container_.Add(std::move(asset));
+            isAdded = true;
+            referenceTable_.AddRef(assetID);
+        }
+    }
+    catch (...)
+    {
+        // Nothing references the asset yet
+        if (isAdded)
+            container_.Release(assetID);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            loadingAssets_.erase(sourceID);
+        }
+        promise.set_exception(std::current_exception());
+        loadCondition_.notify_all();
+        throw;
+    }
+
+    if (!isAdded)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            loadingAssets_.erase(sourceID);
+        }
+        promise.set_exception(std::make_exception_ptr(AssetLoadCancelledError("Asset load cancelled")));
+        loadCondition_.notify_all();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        loadedAssets_[sourceID] = assetID;
+        loadingAssets_.erase(sourceID);
+    }
+    promise.set_value(assetID);
+    loadCondition_.notify_all();
+
+    return true;
+}
+
+void riaecs::AssetLoader::NotifyCancelled()
+{
+    // Taking the lock orders the flag before a joiner's next predicate check, so the wakeup is not lost
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    loadCondition_.notify_all();
+}
+
+std::vector<riaecs::AssetHandle<riaecs::IAsset>> riaecs::AssetLoader::LoadGraph
+(
+    const std::vector<size_t> &sourceIDs, ThreadPool &workers
+){
+    struct GraphNode
+    {
+        std::vector<size_t> dependents;
+        size_t pendingDependencyCount = 0;
+        bool isVisiting = false;
+        bool isVisited = false;
+        bool isLoaded = false;
+        ID assetID;
+    };
+
+    // Collect the dependency closure in topological order
+    std::unordered_map<size_t, GraphNode> nodes;
+    std::vector<size_t> order;
+    {
+        std::vector<std::pair<size_t, size_t>> stack; // Source ID, next dependency index
+        std::unordered_map<size_t, std::vector<size_t>> dependencies;
+
+        for (size_t rootID : sourceIDs)
+        {
+            if (nodes[rootID].isVisited)
+                continue;
+
+            stack.emplace_back(rootID, 0);
+            nodes[rootID].isVisiting = true;
+
+            while (!stack.empty())
+            {
+                size_t sourceID = stack.back().first;
+                size_t &nextIndex = stack.back().second;
+
+                if (dependencies.find(sourceID) == dependencies.end())
+                {
+                    riaecs::ReadOnlyObject<riaecs::AssetSource> source = sourceRegistry_.Get(sourceID);
+                    riaecs::ReadOnlyObject<riaecs::IAssetFactory> assetFactory 
+                    = assetFactoryRegistry_.Get(source().GetAssetFactoryID());
+
+                    std::vector<size_t> sourceDependencies = source().GetDependencies();
+                    for (size_t dependencyID : assetFactory().GetDependencies())
+                        sourceDependencies.push_back(dependencyID);
+
+                    // Ignore duplicated dependencies
+                    std::sort(sourceDependencies.begin(), sourceDependencies.end());
+                    sourceDependencies.erase
+                    (
+                        std::unique(sourceDependencies.begin(), sourceDependencies.end()), sourceDependencies.end()
+                    );
+
+                    nodes[sourceID].pendingDependencyCount = sourceDependencies.size();
+                    dependencies[sourceID] = std::move(sourceDependencies);
+                }
+
+                const std::vector<size_t> &sourceDependencies = dependencies[sourceID];
+                if (nextIndex < sourceDependencies.size())
+                {
+                    size_t dependencyID = sourceDependencies[nextIndex++];
+                    GraphNode &dependencyNode = nodes[dependencyID];
+                    dependencyNode.dependents.push_back(sourceID);
+
+                    if (dependencyNode.isVisiting)
+                        riaecs::NotifyError({"Circular asset dependency at source: " + std::to_string(dependencyID)}, RIAECS_LOG_LOC);
+
+                    if (!dependencyNode.isVisited)
+                    {
+                        dependencyNode.isVisiting = true;
+                        stack.emplace_back(dependencyID, 0);
+                    }
+
+                    continue;
+                }
+
+                nodes[sourceID].isVisiting = false;
+                nodes[sourceID].isVisited = true;
+                order.push_back(sourceID);
+                stack.pop_back();
+            }
+        }
+    }
+
+    std::mutex graphMutex;
+    std::condition_variable graphCondition;
+    size_t remainingCount = order.size();
+    std::exception_ptr error = nullptr;
+
+    // Each node is finished exactly once, either loaded or skipped because a load failed
+    std::function<void(size_t)> loadNode = [&](size_t sourceID)
+    {
+        bool isFailed = false;
+        {
+            std::lock_guard<std::mutex> lock(graphMutex);
+            isFailed = error != nullptr;
+        }
+
+        ID assetID;
+        bool isLoaded = false;
+        if (!isFailed)
+        {
+            try
+            {
+                assetID = Acquire(sourceID);
+                isLoaded = true;
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(graphMutex);
+                if (!error)
+                    error = std::current_exception();
+            }
+        }
+
+        std::vector<size_t> readyIDs;
+        {
+            std::lock_guard<std::mutex> lock(graphMutex);
+
+            GraphNode &node = nodes[sourceID];
+            node.assetID = assetID;
+            node.isLoaded = isLoaded;
+
+            for (size_t dependentID : node.dependents)
+                if (--nodes[dependentID].pendingDependencyCount == 0)
+                    readyIDs.push_back(dependentID);
+        }
+
+        for (size_t readyID : readyIDs)
+            workers.Submit([&loadNode, readyID]() { loadNode(readyID); });
+
+        // Notify under the lock, the waiting thread owns the graph state
+        std::lock_guard<std::mutex> lock(graphMutex);
+        remainingCount--;
+        graphCondition.notify_all();
+    };
+
+    // Collect the leaves before submitting, the workers update the pending counts
+    std::vector<size_t> leafIDs;
+    for (size_t sourceID : order)
+        if (nodes[sourceID].pendingDependencyCount == 0)
+            leafIDs.push_back(sourceID);
+
+    for (size_t leafID : leafIDs)
+        workers.Submit([&loadNode, leafID]() { loadNode(leafID); });
+
+    {
+        std::unique_lock<std::mutex> lock(graphMutex);
+        graphCondition.wait(lock, [&remainingCount]() { return remainingCount == 0; });
+    }
+
+    // Hand the references taken by Acquire over to the handles
+    std::vector<AssetHandle<IAsset>> handles;
+    handles.reserve(order.size());
+    for (size_t sourceID : order)
+    {
+        GraphNode &node = nodes[sourceID];
+        if (!node.isLoaded)
+            continue;
+
+        if (!error)
+            handles.emplace_back(node.assetID, referenceTable_);
+
+        referenceTable_.Release(node.assetID);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return handles;
+}
+
+bool riaecs::AssetLoader::FindLoaded(size_t sourceID, ID &assetID) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = loadedAssets_.find(sourceID);
+    if (it == loadedAssets_.end() || referenceTable_.GetRefCount(it->second) == 0)
+        return false;
+
+    assetID = it->second;
+    return true;
+}
+
+std::unique_ptr<riaecs::IAsset> riaecs::AssetLoader::Reload(size_t sourceID) const
+{
+    return RunStages(sourceID, NOT_CANCELLED);
+}
+
+riaecs::AssetLoadRequest::AssetLoadRequest(size_t sourceID, int priority, AssetReferenceTable &referenceTable) :
+    sourceID_(sourceID), referenceTable_(referenceTable), ENQUEUE_TIME_(AssetLoadProfiler::Clock::now()), 
+    priority_(priority)
+{
+}
+
+void riaecs::AssetLoadRequest::Finish(AssetLoadStatus status)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_ = status;
+    }
+    statusCondition_.notify_all();
+}
+
+int riaecs::AssetLoadRequest::GetPriority() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return priority_;
+}
+
+riaecs::AssetLoadStatus riaecs::AssetLoadRequest::GetStatus() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return status_;
+}
+
+riaecs::AssetLoadStatus riaecs::AssetLoadRequest::Wait() const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    statusCondition_.wait(lock, [this]() 
+    { 
+        return status_ != AssetLoadStatus::Queued && status_ != AssetLoadStatus::Loading; 
+    });
+
+    if (status_ == AssetLoadStatus::Failed && error_)
+        std::rethrow_exception(error_);
+
+    return status_;
+}
+
+riaecs::AssetLoadQueue::AssetLoadQueue(AssetLoader &loader, ThreadPool &workers) : 
+    loader_(loader), workers_(workers)
+{
+}
+
+riaecs::AssetLoadQueue::~AssetLoadQueue()
+{
+    CancelAll();
+
+    // Wait for the submitted tasks, they refer to this queue
+    std::unique_lock<std::mutex> lock(mutex_);
+    taskCondition_.wait(lock, [this]() { return submittedTaskCount_ == 0; });
+}
+
+void riaecs::AssetLoadQueue::RunNext()
+{
+    std::shared_ptr<AssetLoadRequest> request = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Pop the highest priority request, skipping cancelled requests and outdated priorities
+        while (!entries_.empty())
+        {
+            QueueEntry entry = entries_.top();
+            entries_.pop();
+
+            std::lock_guard<std::mutex> requestLock(entry.request->mutex_);
+            if 
+            (
+                entry.request->status_ == AssetLoadStatus::Queued && 
+                entry.priorityVersion == entry.request->priorityVersion_
+            ){
+                entry.request->status_ = AssetLoadStatus::Loading;
+                request = entry.request;
+                queuedCount_--;
+                break;
+            }
+        }
+    }
+
+    if (request)
+    {
+        AssetReferenceTable &referenceTable = loader_.GetReferenceTable();
+        try
+        {
+            if (AssetLoadProfiler *profiler = loader_.GetProfiler())
+            {
+                size_t factoryID = loader_.GetSourceRegistry().Get(request->sourceID_)().GetAssetFactoryID();
+                profiler->RecordQueueWait
+                (
+                    request->sourceID_, factoryID, AssetLoadProfiler::Clock::now() - request->ENQUEUE_TIME_
+                );
+            }
+
+            ID assetID;
+            if (loader_.TryAcquire(request->sourceID_, request->isCancelled_, assetID))
+            {
+                AssetHandle<IAsset> handle(assetID, referenceTable);
+                referenceTable.Release(assetID);
+
+                // Drop the asset if the request was cancelled after the last stage
+                if (request->isCancelled_)
+                {
+                    handle.Reset();
+                    request->Finish(AssetLoadStatus::Cancelled);
+                }
+                else
+                {
+                    {
+                        std::lock_guard<std::mutex> requestLock(request->mutex_);
+                        request->handle_ = std::move(handle);
+                    }
+                    request->Finish(AssetLoadStatus::Loaded);
+                }
+            }
+            else
+            {
+                request->Finish(AssetLoadStatus::Cancelled);
+            }
+        }
+        catch (...)
+        {
+            {
+                std::lock_guard<std::mutex> requestLock(request->mutex_);
+                request->error_ = std::current_exception();
+            }
+            request->Finish(AssetLoadStatus::Failed);
+        }
+    }
+
+    // Notify under the lock, the destructor waits for this task
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (request)
+        activeRequests_.erase(request);
+
+    submittedTaskCount_--;
+    taskCondition_.notify_all();
+}
+
+std::shared_ptr<riaecs::AssetLoadRequest> riaecs::AssetLoadQueue::Enqueue(size_t sourceID, int priority)
+{
+    std::shared_ptr<AssetLoadRequest> request 
+    = std::make_shared<AssetLoadRequest>(sourceID, priority, loader_.GetReferenceTable());
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.push({priority, nextSequence_++, request->priorityVersion_, request});
+        activeRequests_.insert(request);
+        queuedCount_++;
+        submittedTaskCount_++;
+    }
+
+    // Each task starts the highest priority request at the time it runs
+    workers_.Submit([this]() { RunNext(); });
+
+    return request;
+}
+
+void riaecs::AssetLoadQueue::SetPriority(const std::shared_ptr<AssetLoadRequest> &request, int priority)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t priorityVersion = 0;
+    {
+        std::lock_guard<std::mutex> requestLock(request->mutex_);
+        if (request->status_ != AssetLoadStatus::Queued)
+            return;
+
+        request->priority_ = priority;
+        priorityVersion = ++request->priorityVersion_;
+    }
+
+    // The previous entry is skipped because its version is outdated
+    entries_.push({priority, nextSequence_++, priorityVersion, request});
+}
+
+void riaecs::AssetLoadQueue::Cancel(const std::shared_ptr<AssetLoadRequest> &request)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    request->isCancelled_ = true;
+
+    bool isQueued = false;
+    {
+        std::lock_guard<std::mutex> requestLock(request->mutex_);
+        isQueued = request->status_ == AssetLoadStatus::Queued;
+    }
+
+    if (isQueued)
+    {
+        request->Finish(AssetLoadStatus::Cancelled);
+        activeRequests_.erase(request);
+        queuedCount_--;
+    }
+
+    // A running request may be joining another load of the same source
+    loader_.NotifyCancelled();
+}
+
+void riaecs::AssetLoadQueue::CancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = activeRequests_.begin(); it != activeRequests_.end();)
+    {
+        const std::shared_ptr<AssetLoadRequest> &request = *it;
+        request->isCancelled_ = true;
+
+        bool isQueued = false;
+        {
+            std::lock_guard<std::mutex> requestLock(request->mutex_);
+            isQueued = request->status_ == AssetLoadStatus::Queued;
+        }
+
+        if (isQueued)
+        {
+            request->Finish(AssetLoadStatus::Cancelled);
+            queuedCount_--;
+            it = activeRequests_.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    loader_.NotifyCancelled();
+}
+
+size_t riaecs::AssetLoadQueue::GetQueuedCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queuedCount_;
+}
\ No newline at end of file
@@ -0,0 +1,187 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/asset_memory.h"
+
+#include "riaecs/include/utilities.h"
+
+riaecs::AssetMemory::AssetMemory
+(
+    std::unique_ptr<IPoolFactory> poolFactory, std::unique_ptr<IAllocatorFactory> allocatorFactory,
+    size_t chunkSize, size_t maxBlockSize
+) : poolFactory_(std::move(poolFactory)), allocatorFactory_(std::move(allocatorFactory)), CHUNK_SIZE_(chunkSize)
+{
+    if (!poolFactory_ || !allocatorFactory_)
+        riaecs::NotifyError({"PoolFactory and AllocatorFactory must be set"}, RIAECS_LOG_LOC);
+
+    if (maxBlockSize < riaecs::ASSET_MEMORY_MIN_BLOCK_SIZE || maxBlockSize > CHUNK_SIZE_)
+        riaecs::NotifyError({"Max block size must be between the min block size and the chunk size"}, RIAECS_LOG_LOC);
+
+    for (size_t blockSize = riaecs::ASSET_MEMORY_MIN_BLOCK_SIZE; blockSize <= maxBlockSize; blockSize *= 2)
+        blockSizes_.push_back(blockSize);
+
+    chunksWithFreeBlocks_.resize(blockSizes_.size());
+}
+
+riaecs::AssetMemory::~AssetMemory()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    while (!chunks_.empty())
+        DestroyChunk(chunks_.begin());
+}
+
+riaecs::AssetMemory::Chunk &riaecs::AssetMemory::CreateChunk(size_t sizeClass, size_t poolSize, size_t blockSize)
+{
+    std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+    chunk->pool = poolFactory_->Create(poolSize);
+    chunk->allocator = allocatorFactory_->Create(*chunk->pool, blockSize);
+    chunk->sizeClass = sizeClass;
+    chunk->freeBlockCount = poolSize / blockSize;
+
+    Chunk &created = *chunk;
+    chunks_[chunk->pool->GetPool()] = std::move(chunk);
+    return created;
+}
+
+void riaecs::AssetMemory::DestroyChunk(std::map<const std::byte*, std::unique_ptr<Chunk>>::iterator it)
+{
+    allocatorFactory_->Destroy(std::move(it->second->allocator));
+    poolFactory_->Destroy(std::move(it->second->pool));
+    chunks_.erase(it);
+}
+
+std::byte *riaecs::AssetMemory::Malloc(size_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size = std::max(size, riaecs::ASSET_MEMORY_MIN_BLOCK_SIZE);
+
+    auto blockSizeIt = std::lower_bound(blockSizes_.begin(), blockSizes_.end(), size);
+    if (blockSizeIt == blockSizes_.end())
+    {
+        // Round up so that the block can hold the free list link of the allocator
+        size_t poolSize = (size + riaecs::ASSET_MEMORY_MIN_BLOCK_SIZE - 1) & ~(riaecs::ASSET_MEMORY_MIN_BLOCK_SIZE - 1);
+        Chunk &chunk = CreateChunk(LARGE_SIZE_CLASS, poolSize, poolSize);
+        chunk.freeBlockCount = 0;
+        usedSize_ += poolSize;
+
+        return chunk.allocator->Malloc(poolSize, *chunk.pool);
+    }
+
+    size_t sizeClass = static_cast<size_t>(blockSizeIt - blockSizes_.begin());
+    size_t blockSize = *blockSizeIt;
+
+    std::vector<Chunk*> &freeChunks = chunksWithFreeBlocks_[sizeClass];
+    if (freeChunks.empty())
+        freeChunks.push_back(&CreateChunk(sizeClass, CHUNK_SIZE_ - CHUNK_SIZE_ % blockSize, blockSize));
+
+    Chunk &chunk = *freeChunks.back();
+    std::byte *ptr = chunk.allocator->Malloc(blockSize, *chunk.pool);
+
+    chunk.freeBlockCount--;
+    if (chunk.freeBlockCount == 0)
+        freeChunks.pop_back();
+
+    usedSize_ += blockSize;
+    return ptr;
+}
+
+void riaecs::AssetMemory::Free(std::byte *ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = chunks_.upper_bound(ptr);
+    if (it == chunks_.begin())
+        riaecs::NotifyError({"Pointer was not allocated from this asset memory"}, RIAECS_LOG_LOC);
+
+    --it;
+    Chunk &chunk = *it->second;
+    if (ptr >= chunk.pool->GetPool() + chunk.pool->GetSize())
+        riaecs::NotifyError({"Pointer was not allocated from this asset memory"}, RIAECS_LOG_LOC);
+
+    if (chunk.sizeClass == LARGE_SIZE_CLASS)
+    {
+        usedSize_ -= chunk.pool->GetSize();
+        DestroyChunk(it);
+        return;
+    }
+
+    // Fully free chunks are kept for reuse until Reset
+    chunk.allocator->Free(ptr, *chunk.pool);
+    if (chunk.freeBlockCount == 0)
+        chunksWithFreeBlocks_[chunk.sizeClass].push_back(&chunk);
+
+    chunk.freeBlockCount++;
+    usedSize_ -= blockSizes_[chunk.sizeClass];
+}
+
+void riaecs::AssetMemory::Reset()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    while (!chunks_.empty())
+        DestroyChunk(chunks_.begin());
+
+    for (std::vector<Chunk*> &freeChunks : chunksWithFreeBlocks_)
+        freeChunks.clear();
+
+    usedSize_ = 0;
+}
+
+size_t riaecs::AssetMemory::GetUsedSize() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usedSize_;
+}
+
+size_t riaecs::AssetMemory::GetPoolCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return chunks_.size();
+}
+
+riaecs::AssetMemoryBlock::AssetMemoryBlock(IAssetMemory &memory, size_t size) : memory_(&memory), size_(size)
+{
+    data_ = memory_->Malloc(size_);
+}
+
+riaecs::AssetMemoryBlock::~AssetMemoryBlock()
+{
+    Reset();
+}
+
+riaecs::AssetMemoryBlock::AssetMemoryBlock(AssetMemoryBlock &&other) noexcept :
+    memory_(other.memory_), data_(other.data_), size_(other.size_)
+{
+    other.memory_ = nullptr;
+    other.data_ = nullptr;
+    other.size_ = 0;
+}
+
+riaecs::AssetMemoryBlock &riaecs::AssetMemoryBlock::operator=(AssetMemoryBlock &&other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+
+        memory_ = other.memory_;
+        data_ = other.data_;
+        size_ = other.size_;
+
+        other.memory_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+void riaecs::AssetMemoryBlock::Reset()
+{
+    if (memory_ && data_)
+        memory_->Free(data_);
+
+    memory_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+}
\ No newline at end of file
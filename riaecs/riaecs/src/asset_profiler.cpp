@@ -0,0 +1,209 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/asset_profiler.h"
+
+#include "riaecs/include/utilities.h"
+
+#include <sstream>
+#include <iomanip>
+
+namespace
+{
+    constexpr const char *STAGE_NAMES[riaecs::ASSET_LOAD_STAGE_COUNT] = 
+    {
+        "Load", "Decode", "Prepare", "Create", "Commit"
+    };
+
+    double ToMilliseconds(std::chrono::nanoseconds time)
+    {
+        return std::chrono::duration<double, std::milli>(time).count();
+    }
+
+    long long ToMicroseconds(std::chrono::steady_clock::duration time)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+    }
+
+    std::string EscapeJson(std::string_view text)
+    {
+        std::string escaped;
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    void WriteStats(std::ostringstream &report, const std::string &label, const riaecs::AssetLoadStats &stats)
+    {
+        report << label << " loads: " << stats.loadCount << " total: " << ToMilliseconds(stats.GetTotalTime()) << " ms";
+        for (size_t i = 0; i < riaecs::ASSET_LOAD_STAGE_COUNT; ++i)
+            report << " " << STAGE_NAMES[i] << ": " << ToMilliseconds(stats.stageTimes[i]) << " ms";
+
+        report << " queue wait: " << ToMilliseconds(stats.queueWaitTime) << " ms";
+        report << " bytes read: " << stats.bytesRead;
+        report << " peak staging: " << stats.peakStagingSize << "\n";
+    }
+
+    std::vector<std::pair<size_t, riaecs::AssetLoadStats>> SortByTotalTime
+    (
+        const std::map<size_t, riaecs::AssetLoadStats> &stats
+    ){
+        std::vector<std::pair<size_t, riaecs::AssetLoadStats>> sorted(stats.begin(), stats.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+        {
+            return a.second.GetTotalTime() > b.second.GetTotalTime();
+        });
+        return sorted;
+    }
+
+} // namespace
+
+std::chrono::nanoseconds riaecs::AssetLoadStats::GetTotalTime() const
+{
+    std::chrono::nanoseconds total = std::chrono::nanoseconds::zero();
+    for (size_t i = 0; i < ASSET_LOAD_STAGE_COUNT; ++i)
+        total += stageTimes[i];
+
+    return total;
+}
+
+riaecs::AssetLoadProfiler::AssetLoadProfiler() : ORIGIN_(Clock::now())
+{
+}
+
+void riaecs::AssetLoadProfiler::RecordStage
+(
+    size_t sourceID, size_t factoryID, AssetLoadStage stage, Clock::time_point start, Clock::time_point end
+){
+    std::chrono::nanoseconds duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+    size_t stageIndex = static_cast<size_t>(stage);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    sourceStats_[sourceID].stageTimes[stageIndex] += duration;
+    factoryStats_[factoryID].stageTimes[stageIndex] += duration;
+
+    if (isTraceEnabled_)
+    {
+        size_t threadID = std::hash<std::thread::id>()(std::this_thread::get_id());
+        traceEvents_.push_back({sourceID, stage, threadID, start - ORIGIN_, end - start});
+    }
+}
+
+void riaecs::AssetLoadProfiler::RecordLoad
+(
+    size_t sourceID, size_t factoryID, std::string_view filePath, size_t bytesRead, size_t stagingSize
+){
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (AssetLoadStats *stats : {&sourceStats_[sourceID], &factoryStats_[factoryID]})
+    {
+        stats->loadCount++;
+        stats->bytesRead += bytesRead;
+        stats->peakStagingSize = std::max(stats->peakStagingSize, stagingSize);
+    }
+
+    sourcePaths_.emplace(sourceID, std::string(filePath));
+}
+
+void riaecs::AssetLoadProfiler::RecordQueueWait(size_t sourceID, size_t factoryID, Clock::duration waitTime)
+{
+    std::chrono::nanoseconds duration = std::chrono::duration_cast<std::chrono::nanoseconds>(waitTime);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    sourceStats_[sourceID].queueWaitTime += duration;
+    factoryStats_[factoryID].queueWaitTime += duration;
+}
+
+riaecs::AssetLoadStats riaecs::AssetLoadProfiler::GetSourceStats(size_t sourceID) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = sourceStats_.find(sourceID);
+    return it != sourceStats_.end() ? it->second : AssetLoadStats();
+}
+
+riaecs::AssetLoadStats riaecs::AssetLoadProfiler::GetFactoryStats(size_t factoryID) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = factoryStats_.find(factoryID);
+    return it != factoryStats_.end() ? it->second : AssetLoadStats();
+}
+
+std::string riaecs::AssetLoadProfiler::CreateReport() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+
+    report << "Asset load report\n";
+    report << "Factories\n";
+    for (const auto &[factoryID, stats] : SortByTotalTime(factoryStats_))
+        WriteStats(report, "  [Factory " + std::to_string(factoryID) + "]", stats);
+
+    report << "Sources\n";
+    for (const auto &[sourceID, stats] : SortByTotalTime(sourceStats_))
+    {
+        std::string label = "  [Source " + std::to_string(sourceID) + "]";
+
+        auto pathIt = sourcePaths_.find(sourceID);
+        if (pathIt != sourcePaths_.end())
+            label += " " + pathIt->second;
+
+        WriteStats(report, label, stats);
+    }
+
+    return report.str();
+}
+
+void riaecs::AssetLoadProfiler::SetTraceEnabled(bool isEnabled)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    isTraceEnabled_ = isEnabled;
+}
+
+void riaecs::AssetLoadProfiler::WriteTrace(std::string_view filePath) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::ofstream file(std::string(filePath), std::ios::trunc);
+    if (!file.is_open())
+        riaecs::NotifyError({"Failed to open file: " + std::string(filePath)}, RIAECS_LOG_LOC);
+
+    file << "{\"traceEvents\":[";
+    for (size_t i = 0; i < traceEvents_.size(); ++i)
+    {
+        const TraceEvent &event = traceEvents_[i];
+
+        std::string path;
+        auto pathIt = sourcePaths_.find(event.sourceID);
+        if (pathIt != sourcePaths_.end())
+            path = EscapeJson(pathIt->second);
+
+        if (i != 0)
+            file << ",";
+
+        file << "\n{\"name\":\"" << STAGE_NAMES[static_cast<size_t>(event.stage)] << "\",\"cat\":\"asset\",\"ph\":\"X\"";
+        file << ",\"ts\":" << ToMicroseconds(event.start) << ",\"dur\":" << ToMicroseconds(event.duration);
+        file << ",\"pid\":0,\"tid\":" << event.threadID;
+        file << ",\"args\":{\"source\":" << event.sourceID << ",\"path\":\"" << path << "\"}}";
+    }
+    file << "\n]}\n";
+
+    if (!file)
+        riaecs::NotifyError({"Failed to write file: " + std::string(filePath)}, RIAECS_LOG_LOC);
+}
+
+void riaecs::AssetLoadProfiler::Clear()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    sourceStats_.clear();
+    factoryStats_.clear();
+    sourcePaths_.clear();
+    traceEvents_.clear();
+}
\ No newline at end of file
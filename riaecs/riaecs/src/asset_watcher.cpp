@@ -0,0 +1,250 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/asset_watcher.h"
+
+#include "riaecs/include/log.h"
+#include "riaecs/include/utilities.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+riaecs::FileWatcher::FileWatcher()
+{
+#ifdef __linux__
+    inotifyFD_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFD_ < 0)
+        riaecs::NotifyError({"Failed to initialize inotify"}, RIAECS_LOG_LOC);
+#endif
+}
+
+riaecs::FileWatcher::~FileWatcher()
+{
+#ifdef __linux__
+    if (inotifyFD_ >= 0)
+        close(inotifyFD_);
+#endif
+}
+
+std::string riaecs::FileWatcher::NormalizePath(std::string_view filePath)
+{
+    return std::filesystem::absolute(std::filesystem::path(filePath)).lexically_normal().string();
+}
+
+void riaecs::FileWatcher::Watch(std::string_view filePath)
+{
+    std::filesystem::path path(filePath);
+    std::string normalizedPath = NormalizePath(filePath);
+    if (watchedFiles_.find(normalizedPath) != watchedFiles_.end())
+        return;
+
+#ifdef __linux__
+    std::string directory = std::filesystem::path(normalizedPath).parent_path().string();
+    if (directoryWatches_.find(directory) == directoryWatches_.end())
+    {
+        int watch = inotify_add_watch(inotifyFD_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch < 0)
+            riaecs::NotifyError({"Failed to watch directory: " + directory}, RIAECS_LOG_LOC);
+
+        directoryWatches_[directory] = watch;
+        watchedDirectories_[watch] = directory;
+    }
+#else
+    std::error_code error;
+    lastWriteTimes_[normalizedPath] = std::filesystem::last_write_time(path, error);
+#endif
+
+    watchedFiles_.insert(normalizedPath);
+}
+
+std::vector<std::string> riaecs::FileWatcher::Poll()
+{
+    std::unordered_set<std::string> changedPaths;
+
+#ifdef __linux__
+    alignas(inotify_event) char buffer[4096];
+    while (true)
+    {
+        ssize_t length = read(inotifyFD_, buffer, sizeof(buffer));
+        if (length <= 0)
+        {
+            if (length < 0 && errno != EAGAIN)
+                riaecs::NotifyError({"Failed to read inotify events"}, RIAECS_LOG_LOC);
+
+            break;
+        }
+
+        for (char *ptr = buffer; ptr < buffer + length;)
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            auto directoryIt = watchedDirectories_.find(event->wd);
+            if (directoryIt == watchedDirectories_.end() || event->len == 0)
+                continue;
+
+            std::string normalizedPath = NormalizePath((directoryIt->second / event->name).string());
+            if (watchedFiles_.find(normalizedPath) != watchedFiles_.end())
+                changedPaths.insert(std::move(normalizedPath));
+        }
+    }
+#else
+    for (auto &[normalizedPath, lastWriteTime] : lastWriteTimes_)
+    {
+        // The file may be missing while it is being saved, check it again on the next poll
+        std::error_code error;
+        std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(normalizedPath, error);
+        if (error || writeTime == lastWriteTime)
+            continue;
+
+        lastWriteTime = writeTime;
+        changedPaths.insert(normalizedPath);
+    }
+#endif
+
+    return std::vector<std::string>(changedPaths.begin(), changedPaths.end());
+}
+
+riaecs::AssetWatcher::AssetWatcher(AssetLoader &loader, const IAssetSourceRegistry &sourceRegistry, ThreadPool &workers) :
+    loader_(loader), sourceRegistry_(sourceRegistry), workers_(workers)
+{
+}
+
+riaecs::AssetWatcher::~AssetWatcher()
+{
+    WaitIdle();
+}
+
+void riaecs::AssetWatcher::Watch(size_t sourceID)
+{
+    std::string filePath;
+    {
+        riaecs::ReadOnlyObject<riaecs::AssetSource> source = sourceRegistry_.Get(sourceID);
+        filePath = source().GetFilePath();
+    }
+
+    std::lock_guard<std::mutex> lock(watchMutex_);
+
+    std::vector<size_t> &sourceIDs = pathSources_[riaecs::FileWatcher::NormalizePath(filePath)];
+    if (std::find(sourceIDs.begin(), sourceIDs.end(), sourceID) != sourceIDs.end())
+        return;
+
+    sourceIDs.push_back(sourceID);
+    fileWatcher_.Watch(filePath);
+}
+
+void riaecs::AssetWatcher::WatchAll()
+{
+    for (size_t sourceID = 0; sourceID < sourceRegistry_.GetCount(); ++sourceID)
+        Watch(sourceID);
+}
+
+void riaecs::AssetWatcher::StartReload(size_t sourceID)
+{
+    reloadingSources_.insert(sourceID);
+    runningTaskCount_++;
+    workers_.Submit([this, sourceID]() { RunReload(sourceID); });
+}
+
+void riaecs::AssetWatcher::RunReload(size_t sourceID)
+{
+    // Keep the previous asset so that a broken save does not take the running process down. Anything
+    // thrown must be caught here, or the running task count never drops and WaitIdle hangs
+    auto warn = [sourceID](const std::string &reason)
+    {
+        riaecs::Log::OutToConsole
+        (
+            "Hot reload failed for source " + std::to_string(sourceID) + ": " + reason + "\n",
+            riaecs::CONSOLE_TEXT_COLOR_WARNING
+        );
+    };
+
+    std::unique_ptr<riaecs::IAsset> asset = nullptr;
+    try
+    {
+        asset = loader_.Reload(sourceID);
+    }
+    catch (const std::exception &e)
+    {
+        warn(e.what());
+    }
+    catch (...)
+    {
+        warn("unknown exception");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (changedWhileReloading_.erase(sourceID) != 0)
+    {
+        // The file was written again while reloading, the result is already stale
+        runningTaskCount_--;
+        StartReload(sourceID);
+        return;
+    }
+
+    reloadingSources_.erase(sourceID);
+    if (asset)
+        reloadedAssets_.emplace_back(sourceID, std::move(asset));
+
+    runningTaskCount_--;
+    if (runningTaskCount_ == 0)
+        idleCondition_.notify_all();
+}
+
+size_t riaecs::AssetWatcher::Update()
+{
+    std::vector<size_t> changedSourceIDs;
+    {
+        std::lock_guard<std::mutex> lock(watchMutex_);
+
+        for (const std::string &filePath : fileWatcher_.Poll())
+        {
+            auto it = pathSources_.find(filePath);
+            if (it != pathSources_.end())
+                changedSourceIDs.insert(changedSourceIDs.end(), it->second.begin(), it->second.end());
+        }
+    }
+
+    std::vector<std::pair<size_t, std::unique_ptr<riaecs::IAsset>>> reloadedAssets;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        for (size_t sourceID : changedSourceIDs)
+        {
+            // Sources which are not loaded pick up the new file on their next load
+            riaecs::ID assetID;
+            if (!loader_.FindLoaded(sourceID, assetID))
+                continue;
+
+            if (reloadingSources_.find(sourceID) != reloadingSources_.end())
+                changedWhileReloading_.insert(sourceID);
+            else
+                StartReload(sourceID);
+        }
+
+        reloadedAssets.swap(reloadedAssets_);
+    }
+
+    size_t swappedCount = 0;
+    riaecs::IAssetContainer &container = loader_.GetContainer();
+    for (auto &[sourceID, asset] : reloadedAssets)
+    {
+        // The asset may have been unloaded while it was reloading
+        riaecs::ID assetID;
+        if (!loader_.FindLoaded(sourceID, assetID) || !container.Contains(assetID))
+            continue;
+
+        container.Set(assetID, std::move(asset));
+        swappedCount++;
+    }
+
+    return swappedCount;
+}
+
+void riaecs::AssetWatcher::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return runningTaskCount_ == 0; });
+}
\ No newline at end of file
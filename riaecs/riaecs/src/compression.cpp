@@ -0,0 +1,230 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/compression.h"
+
+#include "riaecs/include/utilities.h"
+
+#include <cstring>
+#include <cstdint>
+
+namespace
+{
+    constexpr std::byte MAGIC[4] = { std::byte{'R'}, std::byte{'L'}, std::byte{'Z'}, std::byte{'1'} };
+    constexpr size_t HASH_BITS = 14;
+    constexpr size_t NO_POSITION = static_cast<size_t>(-1);
+    constexpr size_t LENGTH_MASK = 15;
+
+    uint32_t Read32(const std::byte *data)
+    {
+        uint32_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    size_t Hash(uint32_t sequence)
+    {
+        return static_cast<size_t>((sequence * 2654435761u) >> (32 - HASH_BITS));
+    }
+
+    // Lengths which do not fit in the token continue with bytes of 255 and a final byte below 255
+    void WriteLength(std::vector<std::byte> &output, size_t length)
+    {
+        while (length >= 255)
+        {
+            output.push_back(std::byte{255});
+            length -= 255;
+        }
+        output.push_back(static_cast<std::byte>(length));
+    }
+
+    void WriteSequence
+    (
+        std::vector<std::byte> &output, const std::byte *literals, size_t literalLength,
+        size_t offset, size_t matchLength
+    ){
+        bool hasMatch = matchLength != 0;
+        size_t matchCode = hasMatch ? matchLength - riaecs::LZCodec::MIN_MATCH_LENGTH : 0;
+
+        output.push_back(static_cast<std::byte>
+        (
+            (std::min(literalLength, LENGTH_MASK) << 4) | std::min(matchCode, LENGTH_MASK)
+        ));
+
+        if (literalLength >= LENGTH_MASK)
+            WriteLength(output, literalLength - LENGTH_MASK);
+
+        output.insert(output.end(), literals, literals + literalLength);
+
+        if (!hasMatch)
+            return;
+
+        output.push_back(static_cast<std::byte>(offset & 0xFF));
+        output.push_back(static_cast<std::byte>(offset >> 8));
+
+        if (matchCode >= LENGTH_MASK)
+            WriteLength(output, matchCode - LENGTH_MASK);
+    }
+
+    size_t ReadLength(const std::byte *data, size_t size, size_t &position)
+    {
+        size_t length = 0;
+        while (true)
+        {
+            if (position >= size)
+                riaecs::NotifyError({"Corrupted compressed data: truncated length"}, RIAECS_LOG_LOC);
+
+            size_t value = static_cast<size_t>(data[position++]);
+            length += value;
+            if (value != 255)
+                return length;
+        }
+    }
+
+} // namespace
+
+std::vector<std::byte> riaecs::LZCodec::Compress(const std::byte *data, size_t size)
+{
+    std::vector<std::byte> output;
+    output.reserve(HEADER_SIZE + size + size / 255 + 16);
+
+    output.insert(output.end(), std::begin(MAGIC), std::end(MAGIC));
+    for (size_t i = 0; i < 8; ++i)
+        output.push_back(static_cast<std::byte>((static_cast<uint64_t>(size) >> (i * 8)) & 0xFF));
+
+    std::vector<size_t> hashTable(static_cast<size_t>(1) << HASH_BITS, NO_POSITION);
+    size_t anchor = 0;
+    size_t position = 0;
+    while (position + MIN_MATCH_LENGTH <= size)
+    {
+        uint32_t sequence = Read32(data + position);
+        size_t &entry = hashTable[Hash(sequence)];
+        size_t candidate = entry;
+        entry = position;
+
+        if 
+        (
+            candidate == NO_POSITION || position - candidate > MAX_MATCH_OFFSET || 
+            Read32(data + candidate) != sequence
+        ){
+            position++;
+            continue;
+        }
+
+        size_t matchLength = MIN_MATCH_LENGTH;
+        while (position + matchLength < size && data[candidate + matchLength] == data[position + matchLength])
+            matchLength++;
+
+        WriteSequence(output, data + anchor, position - anchor, position - candidate, matchLength);
+        position += matchLength;
+        anchor = position;
+    }
+
+    WriteSequence(output, data + anchor, size - anchor, 0, 0);
+    return output;
+}
+
+size_t riaecs::LZCodec::GetDecompressedSize(const std::byte *data, size_t size)
+{
+    if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+        riaecs::NotifyError({"Data is not LZCodec compressed"}, RIAECS_LOG_LOC);
+
+    uint64_t decompressedSize = 0;
+    for (size_t i = 0; i < 8; ++i)
+        decompressedSize |= static_cast<uint64_t>(data[sizeof(MAGIC) + i]) << (i * 8);
+
+    return static_cast<size_t>(decompressedSize);
+}
+
+void riaecs::LZCodec::Decompress(const std::byte *data, size_t size, std::byte *output, size_t outputSize)
+{
+    if (GetDecompressedSize(data, size) != outputSize)
+        riaecs::NotifyError({"Output size does not match the decompressed size"}, RIAECS_LOG_LOC);
+
+    size_t inputPosition = HEADER_SIZE;
+    size_t outputPosition = 0;
+    while (true)
+    {
+        if (inputPosition >= size)
+            riaecs::NotifyError({"Corrupted compressed data: missing sequence"}, RIAECS_LOG_LOC);
+
+        size_t token = static_cast<size_t>(data[inputPosition++]);
+
+        size_t literalLength = token >> 4;
+        if (literalLength == LENGTH_MASK)
+            literalLength += ReadLength(data, size, inputPosition);
+
+        if (literalLength > size - inputPosition || literalLength > outputSize - outputPosition)
+            riaecs::NotifyError({"Corrupted compressed data: literals out of range"}, RIAECS_LOG_LOC);
+
+        if (literalLength > 0)
+            std::memcpy(output + outputPosition, data + inputPosition, literalLength); // Output may be null when empty
+        inputPosition += literalLength;
+        outputPosition += literalLength;
+
+        if (inputPosition == size)
+            break; // The last sequence has no match
+
+        if (size - inputPosition < 2)
+            riaecs::NotifyError({"Corrupted compressed data: truncated offset"}, RIAECS_LOG_LOC);
+
+        size_t offset = static_cast<size_t>(data[inputPosition]) | (static_cast<size_t>(data[inputPosition + 1]) << 8);
+        inputPosition += 2;
+
+        size_t matchLength = (token & LENGTH_MASK) + MIN_MATCH_LENGTH;
+        if ((token & LENGTH_MASK) == LENGTH_MASK)
+            matchLength += ReadLength(data, size, inputPosition);
+
+        if (offset == 0 || offset > outputPosition || matchLength > outputSize - outputPosition)
+            riaecs::NotifyError({"Corrupted compressed data: match out of range"}, RIAECS_LOG_LOC);
+
+        std::byte *dst = output + outputPosition;
+        const std::byte *src = dst - offset;
+        if (offset >= matchLength)
+            std::memcpy(dst, src, matchLength);
+        else
+            for (size_t i = 0; i < matchLength; ++i)
+                dst[i] = src[i]; // Overlapping match repeats the last offset bytes
+
+        outputPosition += matchLength;
+    }
+
+    if (outputPosition != outputSize)
+        riaecs::NotifyError({"Corrupted compressed data: size mismatch"}, RIAECS_LOG_LOC);
+}
+
+void riaecs::LZCodec::CompressFile(std::string_view srcFilePath, std::string_view dstFilePath)
+{
+    riaecs::BinaryFileLoader fileLoader;
+    std::unique_ptr<riaecs::IFileData> fileData = fileLoader.Load(srcFilePath);
+    const riaecs::MemoryFileData &memoryData = static_cast<const riaecs::MemoryFileData&>(*fileData);
+
+    std::vector<std::byte> compressed = Compress(memoryData.GetData(), memoryData.GetSize());
+
+    std::ofstream file(std::string(dstFilePath), std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        riaecs::NotifyError({"Failed to open file: " + std::string(dstFilePath)}, RIAECS_LOG_LOC);
+
+    file.write(reinterpret_cast<const char*>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+    if (!file)
+        riaecs::NotifyError({"Failed to write file: " + std::string(dstFilePath)}, RIAECS_LOG_LOC);
+}
+
+std::unique_ptr<riaecs::IFileData> riaecs::LZFileDecoder::Decode(const IFileData &fileData) const
+{
+    const riaecs::MemoryFileData *memoryData = dynamic_cast<const riaecs::MemoryFileData*>(&fileData);
+    if (!memoryData)
+        riaecs::NotifyError({"LZFileDecoder requires MemoryFileData"}, RIAECS_LOG_LOC);
+
+    size_t decompressedSize = riaecs::LZCodec::GetDecompressedSize(memoryData->GetData(), memoryData->GetSize());
+
+    if (memory_)
+    {
+        riaecs::AssetMemoryBlock block(*memory_, decompressedSize);
+        riaecs::LZCodec::Decompress(memoryData->GetData(), memoryData->GetSize(), block.GetData(), block.GetSize());
+        return std::make_unique<riaecs::MemoryFileData>(std::move(block));
+    }
+
+    riaecs::ByteBuffer buffer = bufferPool_.Acquire(decompressedSize);
+    riaecs::LZCodec::Decompress(memoryData->GetData(), memoryData->GetSize(), buffer.data(), buffer.size());
+
+    return std::make_unique<riaecs::MemoryFileData>(std::move(buffer), bufferPool_);
+}
\ No newline at end of file
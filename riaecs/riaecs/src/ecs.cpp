@@ -4,378 +4,1912 @@
 #include "riaecs/include/utilities.h"
 #include "riaecs/include/global_registry.h"
 
+namespace
+{
+    // Blocks must hold the free list link and keep every component in the pool aligned
+    size_t GetComponentBlockSize(const riaecs::ComponentMeta &meta)
+    {
+        size_t blockSize = std::max(meta.size, riaecs::MAX_FREE_BLOCK_SIZE);
+        size_t alignment = std::max<size_t>(meta.alignment, 1);
+        return (blockSize + alignment - 1) / alignment * alignment;
+    }
+
+    size_t CountTrailingZeros(uint64_t word)
+    {
+#ifdef _MSC_VER
+        unsigned long index = 0;
+        _BitScanForward64(&index, word);
+        return index;
+#else
+        return static_cast<size_t>(__builtin_ctzll(word));
+#endif
+    }
+
+    // Values captured with one meta can be stored with the other: same layout and the same storage kind
+    bool IsLayoutCompatible(const riaecs::ComponentMeta &a, const riaecs::ComponentMeta &b)
+    {
+        if (a.size != b.size || a.alignment != b.alignment || a.isTag != b.isTag || a.isShared != b.isShared)
+            return false;
+
+        if (!a.cold || !b.cold)
+            return a.cold == b.cold;
+
+        return a.cold->size == b.cold->size && a.cold->alignment == b.cold->alignment;
+    }
+
+    // Builds a mask with the bits of componentIDs set
+    std::vector<uint64_t> MakeSignatureMask(const std::vector<size_t> &componentIDs, size_t wordCount)
+    {
+        std::vector<uint64_t> mask(wordCount, 0);
+        for (size_t componentID : componentIDs)
+            mask[componentID / 64] |= uint64_t(1) << (componentID % 64);
+        return mask;
+    }
+
+    // An aligned heap block for one value outside any pool
+    class ScratchBlock
+    {
+    private:
+        std::align_val_t alignment_;
+        std::byte *data_;
+
+    public:
+        explicit ScratchBlock(const riaecs::ComponentMeta &meta) : 
+            alignment_{std::max<size_t>(meta.alignment, alignof(std::max_align_t))}, 
+            data_(static_cast<std::byte*>(::operator new(meta.size, alignment_)))
+        {
+        }
+
+        ~ScratchBlock() { ::operator delete(data_, alignment_); }
+
+        ScratchBlock(const ScratchBlock&) = delete;
+        ScratchBlock& operator=(const ScratchBlock&) = delete;
+
+        std::byte *Get() const { return data_; }
+    };
+
+    // Function local so registrars running during static initialisation of other modules find it built
+    struct ComponentTypeIDs
+    {
+        std::mutex mutex;
+        std::unordered_map<std::type_index, size_t> ids;
+    };
+
+    ComponentTypeIDs &GetComponentTypeIDs()
+    {
+        static ComponentTypeIDs componentTypeIDs;
+        return componentTypeIDs;
+    }
+
+    // Moves the values around inside the blocks they already own so the blocks ascend in dense order.
+    // Each permutation cycle is followed with one spare value. Returns false when the deadline passes
+    // first, every value is in a valid block then and the next call carries on from there
+    bool SortBlocksByAddress
+    (
+        const riaecs::ComponentMeta &meta, std::vector<std::byte*> &blocks, 
+        std::chrono::steady_clock::time_point deadline
+    ){
+        if (std::is_sorted(blocks.begin(), blocks.end()))
+            return true;
+
+        std::vector<std::byte*> sorted = blocks;
+        std::sort(sorted.begin(), sorted.end());
+        auto rankOf = [&sorted](std::byte *block)
+        {
+            return static_cast<size_t>(std::lower_bound(sorted.begin(), sorted.end(), block) - sorted.begin());
+        };
+
+        // holders[rank] is the dense position whose value sits in sorted[rank]
+        std::vector<size_t> holders(blocks.size());
+        for (size_t i = 0; i < blocks.size(); ++i)
+            holders[rankOf(blocks[i])] = i;
+
+        constexpr size_t MOVES_PER_DEADLINE_CHECK = 64;
+        size_t moveCount = 0;
+
+        ScratchBlock spare(meta);
+        for (size_t start = 0; start < blocks.size(); ++start)
+        {
+            if (blocks[start] == sorted[start])
+                continue;
+
+            // Free sorted[start], then keep filling the freed block with the value that belongs there
+            size_t sparePosition = holders[start];
+            meta.Move(spare.Get(), sorted[start]);
+
+            size_t position = start;
+            while (position != sparePosition)
+            {
+                std::byte *source = blocks[position];
+                meta.Move(sorted[position], source);
+                blocks[position] = sorted[position];
+                position = rankOf(source);
+
+                if (++moveCount % MOVES_PER_DEADLINE_CHECK == 0 && std::chrono::steady_clock::now() >= deadline)
+                {
+                    // Close the cycle early by parking the spare value in the free block
+                    meta.Move(sorted[position], spare.Get());
+                    blocks[sparePosition] = sorted[position];
+                    return false;
+                }
+            }
+
+            meta.Move(sorted[sparePosition], spare.Get());
+            blocks[sparePosition] = sorted[sparePosition];
+        }
+
+        return true;
+    }
+
+} // namespace
+
+void riaecs::SetComponentTypeID(std::type_index type, size_t componentID)
+{
+    ComponentTypeIDs &componentTypeIDs = GetComponentTypeIDs();
+    std::lock_guard<std::mutex> lock(componentTypeIDs.mutex);
+
+    auto [it, isInserted] = componentTypeIDs.ids.try_emplace(type, componentID);
+    if (!isInserted && it->second != componentID)
+    {
+        riaecs::NotifyError
+        (
+            {
+                "Component type is already registered with another ID: ", type.name(), 
+                ". Every registry must give a type the same ID"
+            }, 
+            RIAECS_LOG_LOC
+        );
+    }
+}
+
+size_t riaecs::FindComponentTypeID(std::type_index type)
+{
+    ComponentTypeIDs &componentTypeIDs = GetComponentTypeIDs();
+    std::lock_guard<std::mutex> lock(componentTypeIDs.mutex);
+
+    auto it = componentTypeIDs.ids.find(type);
+    return it != componentTypeIDs.ids.end() ? it->second : riaecs::INVALID_COMPONENT_ID;
+}
+
+riaecs::Prefab::~Prefab()
+{
+    for (Component &component : components_)
+    {
+        if (!component.data)
+            continue;
+
+        component.meta.Destroy(component.data);
+        ::operator delete(component.data, std::align_val_t(component.meta.alignment));
+
+        if (!component.coldData)
+            continue;
+
+        component.meta.cold->Destroy(component.coldData);
+        ::operator delete(component.coldData, std::align_val_t(component.meta.cold->alignment));
+    }
+}
+
+riaecs::Prefab::Prefab(Prefab &&other) noexcept
+: components_(std::move(other.components_))
+{
+    other.components_.clear();
+}
+
+riaecs::Prefab &riaecs::Prefab::operator=(Prefab &&other) noexcept
+{
+    if (this != &other)
+    {
+        Prefab discarded(std::move(*this));
+        components_ = std::move(other.components_);
+        other.components_.clear();
+    }
+
+    return *this;
+}
+
+void riaecs::Prefab::Add(size_t componentID, const ComponentMeta &meta, const std::byte *src, const std::byte *coldSrc)
+{
+    for (const Component &component : components_)
+        if (component.componentID == componentID)
+            riaecs::NotifyError({"Prefab already has this component"}, RIAECS_LOG_LOC);
+
+    Component component;
+    component.componentID = componentID;
+    component.meta = meta;
+
+    if (!meta.isTag)
+    {
+        if (!src)
+            riaecs::NotifyError({"Prefab component needs a value to copy"}, RIAECS_LOG_LOC);
+
+        if (!meta.isTriviallyCopyable && !meta.copy)
+            riaecs::NotifyError({"Prefab component cannot be copied"}, RIAECS_LOG_LOC);
+
+        component.data = static_cast<std::byte*>(::operator new(meta.size, std::align_val_t(meta.alignment)));
+        try
+        {
+            meta.Copy(component.data, src);
+        }
+        catch (...)
+        {
+            ::operator delete(component.data, std::align_val_t(meta.alignment));
+            throw;
+        }
+    }
+
+    if (meta.cold)
+    {
+        const ComponentMeta &cold = *meta.cold;
+        if (!coldSrc)
+            riaecs::NotifyError({"Prefab component needs a cold value to copy"}, RIAECS_LOG_LOC);
+
+        if (!cold.isTriviallyCopyable && !cold.copy)
+            riaecs::NotifyError({"Prefab component cannot be copied"}, RIAECS_LOG_LOC);
+
+        component.coldData = static_cast<std::byte*>(::operator new(cold.size, std::align_val_t(cold.alignment)));
+        try
+        {
+            cold.Copy(component.coldData, coldSrc);
+        }
+        catch (...)
+        {
+            ::operator delete(component.coldData, std::align_val_t(cold.alignment));
+            meta.Destroy(component.data);
+            ::operator delete(component.data, std::align_val_t(meta.alignment));
+            throw;
+        }
+    }
+
+    components_.push_back(component);
+}
+
 size_t riaecs::ECSWorld::nextRegisterIndex_ = 0;
 
-riaecs::ECSWorld::~ECSWorld()
+riaecs::ECSWorld::~ECSWorld()
+{
+    DestroyWorld();
+}
+
+void riaecs::ECSWorld::SetComponentFactoryRegistry(std::unique_ptr<IComponentFactoryRegistry> registry)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    componentFactoryRegistry_ = std::move(registry);
+}
+
+void riaecs::ECSWorld::SetPoolFactory(std::unique_ptr<IPoolFactory> poolFactory)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    poolFactory_ = std::move(poolFactory);
+}
+
+void riaecs::ECSWorld::SetAllocatorFactory(std::unique_ptr<IAllocatorFactory> allocatorFactory)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    allocatorFactory_ = std::move(allocatorFactory);
+}
+
+void riaecs::ECSWorld::SetComponentMaxCountRegistry(std::unique_ptr<IComponentMaxCountRegistry> registry)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    componentMaxCountRegistry_ = std::move(registry);
+}
+
+bool riaecs::ECSWorld::IsReady() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!componentFactoryRegistry_)
+    {
+        riaecs::NotifyError({"ComponentFactoryRegistry is not set"}, RIAECS_LOG_LOC);
+        isReady_ = false;
+        return isReady_;
+    }
+
+    if (!poolFactory_)
+    {
+        riaecs::NotifyError({"PoolFactory is not set"}, RIAECS_LOG_LOC);
+        isReady_ = false;
+        return isReady_;
+    }
+
+    if (!allocatorFactory_)
+    {
+        riaecs::NotifyError({"AllocatorFactory is not set"}, RIAECS_LOG_LOC);
+        isReady_ = false;
+        return isReady_;
+    }
+
+    if (!componentMaxCountRegistry_)
+    {
+        riaecs::NotifyError({"ComponentMaxCountRegistry is not set"}, RIAECS_LOG_LOC);
+        isReady_ = false;
+        return isReady_;
+    }
+
+    isReady_ = true;
+    return isReady_;
+}
+
+void riaecs::ECSWorld::CreateWorld()
+{
+    if (!IsReady())
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // The pools are sized from the registries, so they cannot change from here on
+    componentFactoryRegistry_->Freeze();
+    componentMaxCountRegistry_->Freeze();
+
+    // Initialize component pools and allocators
+    size_t componentCount = componentFactoryRegistry_->GetCount();
+    componentPools_.resize(componentCount);
+    componentAllocators_.resize(componentCount);
+    componentMetas_.resize(componentCount);
+    coldPools_.resize(componentCount);
+    coldAllocators_.resize(componentCount);
+    componentObservers_.resize(componentCount);
+    componentStorages_.resize(componentCount);
+    componentGroups_.assign(componentCount, NULL_POSITION);
+    sharedInstances_.resize(componentCount);
+    signatureWordCount_ = (componentCount + 63) / 64;
+
+    for (size_t i = 0; i < componentCount; ++i)
+    {
+        riaecs::ReadOnlyObject<IComponentFactory> factory = componentFactoryRegistry_->Get(i);
+        riaecs::ReadOnlyObject<size_t> maxCount = componentMaxCountRegistry_->Get(i);
+
+        // Copy the metadata so that component operations do not go through the factory
+        componentMetas_[i] = factory().GetMeta();
+
+        // Tags only need the membership arrays
+        if (componentMetas_[i].isTag)
+            continue;
+
+        // For shared components maxCount is the number of distinct values, as only those take a block
+        size_t blockSize = GetComponentBlockSize(componentMetas_[i]);
+        componentPools_[i] = poolFactory_->Create(blockSize * maxCount());
+        componentAllocators_[i] = allocatorFactory_->Create(*componentPools_[i], blockSize);
+
+        // The cold part of a split component gets a pool of its own
+        if (!componentMetas_[i].cold)
+            continue;
+
+        size_t coldBlockSize = GetComponentBlockSize(*componentMetas_[i].cold);
+        coldPools_[i] = poolFactory_->Create(coldBlockSize * maxCount());
+        coldAllocators_[i] = allocatorFactory_->Create(*coldPools_[i], coldBlockSize);
+    }
+}
+
+void riaecs::ECSWorld::DestroyWorld()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // Clear all component data
+    ReleaseAllComponents();
+    signatures_.clear();
+
+    // Destroy pools and allocators
+    for (size_t i = 0; i < componentPools_.size(); ++i)
+        if (componentPools_[i])
+            poolFactory_->Destroy(std::move(componentPools_[i]));
+    componentPools_.clear();
+
+    for (size_t i = 0; i < componentAllocators_.size(); ++i)
+        if (componentAllocators_[i])
+            allocatorFactory_->Destroy(std::move(componentAllocators_[i]));
+    componentAllocators_.clear();
+
+    for (size_t i = 0; i < coldPools_.size(); ++i)
+        if (coldPools_[i])
+            poolFactory_->Destroy(std::move(coldPools_[i]));
+    coldPools_.clear();
+
+    for (size_t i = 0; i < coldAllocators_.size(); ++i)
+        if (coldAllocators_[i])
+            allocatorFactory_->Destroy(std::move(coldAllocators_[i]));
+    coldAllocators_.clear();
+    componentMetas_.clear();
+
+    // Pending events are dropped along with the world
+    componentObservers_.clear();
+    componentStorages_.clear();
+    groups_.clear();
+    componentGroups_.clear();
+    sharedInstances_.clear();
+    compactCursor_ = 0;
+
+    // Reset entity management
+    entitySlots_.clear();
+    freeSlotHead_ = riaecs::ENTITY_NULL_INDEX;
+
+    // Reset ready state
+    isReady_ = false;
+}
+
+void riaecs::ECSWorld::ValidateEntity(const Entity &entity) const
+{
+    // Live entities match their slot exactly
+    if (entity.GetIndex() < entitySlots_.size() && entitySlots_[entity.GetIndex()] == entity)
+        return;
+
+    if (entity.GetIndex() >= entitySlots_.size())
+        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+
+    if (!IsSlotAlive(entity.GetIndex()))
+        riaecs::NotifyError({"Entity does not exist"}, RIAECS_LOG_LOC);
+
+    riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+}
+
+riaecs::Entity riaecs::ECSWorld::AllocateEntity()
+{
+    if (freeSlotHead_ != riaecs::ENTITY_NULL_INDEX)
+    {
+        // Pop the free list and revive the slot with the next generation
+        size_t index = freeSlotHead_;
+        Entity &slot = entitySlots_[index];
+        freeSlotHead_ = slot.GetIndex();
+        slot = Entity(index, slot.GetGeneration() + 1);
+
+        return slot;
+    }
+    else
+    {
+        size_t index = entitySlots_.size();
+        if (index > riaecs::ENTITY_MAX_INDEX)
+            riaecs::NotifyError({"Entity index exceeds the handle's index bits"}, RIAECS_LOG_LOC);
+
+        signatures_.resize(signatures_.size() + signatureWordCount_, 0);
+        entitySlots_.push_back(Entity(index, riaecs::ID_DEFAULT_GENERATION));
+
+        return entitySlots_.back();
+    }
+}
+
+void riaecs::ECSWorld::ReleaseEntity(const Entity &entity)
+{
+    // Remove all components associated with the entity, walking the set bits of its signature
+    uint64_t *signature = GetSignature(entity.GetIndex());
+    for (size_t wordIndex = 0; wordIndex < signatureWordCount_; ++wordIndex)
+    {
+        uint64_t word = signature[wordIndex];
+        signature[wordIndex] = 0;
+
+        while (word != 0)
+        {
+            size_t componentID = wordIndex * 64 + CountTrailingZeros(word);
+            word &= word - 1;
+
+            // Remove the component from the entity
+            if (componentGroups_[componentID] != NULL_POSITION)
+                LeaveGroup(componentGroups_[componentID], entity.GetIndex());
+
+            std::pair<std::byte*, std::byte*> componentData = EraseFromStorage(componentID, entity.GetIndex());
+
+            if (!componentObservers_[componentID].observers.empty())
+                componentObservers_[componentID].events.push_back({entity, false});
+
+            // Free the component data which was allocated for this entity
+            FreeComponentData(componentID, componentData.first, componentData.second);
+        }
+    }
+
+    // Push the slot onto the free list, keeping its generation for the next reuse
+    entitySlots_[entity.GetIndex()] = Entity(freeSlotHead_, entity.GetGeneration());
+    freeSlotHead_ = entity.GetIndex();
+}
+
+void riaecs::ECSWorld::FreeComponentData(size_t componentID, std::byte *data, std::byte *coldData)
+{
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+    if (meta.isTag)
+        return;
+
+    if (meta.isShared)
+    {
+        ReleaseInstance(componentID, data);
+        return;
+    }
+
+    meta.Destroy(data);
+    componentAllocators_[componentID]->Free(data, *componentPools_[componentID]);
+
+    if (!coldData)
+        return;
+
+    meta.cold->Destroy(coldData);
+    coldAllocators_[componentID]->Free(coldData, *coldPools_[componentID]);
+}
+
+std::byte *riaecs::ECSWorld::FindInstance(size_t componentID, const std::byte *value, size_t hash) const
+{
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+    auto [first, last] = sharedInstances_[componentID].byHash.equal_range(hash);
+    for (auto it = first; it != last; ++it)
+        if (meta.equal(it->second, value))
+            return it->second;
+
+    return nullptr;
+}
+
+std::byte *riaecs::ECSWorld::ShareInstance(size_t componentID, std::byte *data)
+{
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+    SharedInstances &instances = sharedInstances_[componentID];
+
+    size_t hash = meta.hash(data);
+    std::byte *existing = FindInstance(componentID, data, hash);
+    if (existing)
+    {
+        // Reference the existing instance and give the block back
+        meta.Destroy(data);
+        componentAllocators_[componentID]->Free(data, *componentPools_[componentID]);
+        ++instances.entries[existing].refCount;
+        return existing;
+    }
+
+    instances.byHash.emplace(hash, data);
+    instances.entries[data] = SharedInstance{1, hash};
+    return data;
+}
+
+std::byte *riaecs::ECSWorld::ShareValue(size_t componentID, std::byte *value)
+{
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+    SharedInstances &instances = sharedInstances_[componentID];
+
+    size_t hash = 0;
+    std::byte *existing = nullptr;
+    try
+    {
+        hash = meta.hash(value);
+        existing = FindInstance(componentID, value, hash);
+    }
+    catch (...)
+    {
+        meta.Destroy(value);
+        throw;
+    }
+
+    if (existing)
+    {
+        meta.Destroy(value);
+        ++instances.entries[existing].refCount;
+        return existing;
+    }
+
+    // Only a new value takes a block
+    std::byte *data = componentAllocators_[componentID]->Malloc(GetComponentBlockSize(meta), *componentPools_[componentID]);
+    if (!data)
+    {
+        meta.Destroy(value);
+        riaecs::NotifyError({"Shared component has more distinct values than its max count"}, RIAECS_LOG_LOC);
+    }
+
+    try
+    {
+        meta.Move(data, value);
+    }
+    catch (...)
+    {
+        componentAllocators_[componentID]->Free(data, *componentPools_[componentID]);
+        meta.Destroy(value);
+        throw;
+    }
+
+    instances.byHash.emplace(hash, data);
+    instances.entries[data] = SharedInstance{1, hash};
+    return data;
+}
+
+void riaecs::ECSWorld::UnindexInstance(size_t componentID, std::byte *data)
+{
+    // The stored hash is used, the value may not hash the same anymore
+    SharedInstances &instances = sharedInstances_[componentID];
+    auto [first, last] = instances.byHash.equal_range(instances.entries.at(data).hash);
+    for (auto it = first; it != last; ++it)
+    {
+        if (it->second == data)
+        {
+            instances.byHash.erase(it);
+            return;
+        }
+    }
+}
+
+void riaecs::ECSWorld::ReleaseInstance(size_t componentID, std::byte *data)
+{
+    SharedInstances &instances = sharedInstances_[componentID];
+    auto entry = instances.entries.find(data);
+    if (--entry->second.refCount != 0)
+        return;
+
+    UnindexInstance(componentID, data);
+    instances.entries.erase(entry);
+
+    componentMetas_[componentID].Destroy(data);
+    componentAllocators_[componentID]->Free(data, *componentPools_[componentID]);
+}
+
+void riaecs::ECSWorld::ReleaseAllComponents()
+{
+    for (size_t componentID = 0; componentID < componentStorages_.size(); ++componentID)
+    {
+        ComponentStorage &storage = componentStorages_[componentID];
+
+        // Every member of an observed component is removed
+        ComponentObservers &observers = componentObservers_[componentID];
+        if (!observers.observers.empty())
+            for (const Entity &entity : storage.entities)
+                observers.events.push_back({entity, false});
+
+        // The pools are released as a whole, so only components with a destructor need to be visited
+        const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+        if (meta.isShared)
+        {
+            // Each instance is destroyed once however many entities reference it
+            SharedInstances &instances = sharedInstances_[componentID];
+            if (!meta.isTriviallyDestructible)
+                for (const std::pair<std::byte *const, SharedInstance> &entry : instances.entries)
+                    meta.Destroy(entry.first);
+
+            instances.entries.clear();
+            instances.byHash.clear();
+        }
+        else if (!meta.isTag && !meta.isTriviallyDestructible)
+            for (std::byte *componentData : storage.data)
+                meta.Destroy(componentData);
+
+        if (meta.cold && !meta.cold->isTriviallyDestructible)
+            for (std::byte *coldData : storage.coldData)
+                meta.cold->Destroy(coldData);
+
+        storage.entities.clear();
+        storage.data.clear();
+        storage.coldData.clear();
+        storage.addedTicks.clear();
+        storage.changedTicks.clear();
+        storage.sparse.clear();
+    }
+
+    std::fill(signatures_.begin(), signatures_.end(), 0);
+
+    for (size_t groupID = 0; groupID < groups_.size(); ++groupID)
+    {
+        groups_[groupID].data.size = 0;
+        RefreshGroup(groupID);
+    }
+}
+
+void riaecs::ECSWorld::InsertToStorage(size_t componentID, const Entity &entity, std::byte *data, std::byte *coldData)
+{
+    ComponentStorage &storage = componentStorages_[componentID];
+    if (entity.GetIndex() >= storage.sparse.size())
+        storage.sparse.resize(entity.GetIndex() + 1, NULL_POSITION);
+
+    uint64_t tick = currentTick_.load(std::memory_order_relaxed);
+    storage.sparse[entity.GetIndex()] = storage.entities.size();
+    storage.entities.push_back(entity);
+    storage.data.push_back(data);
+    storage.coldData.push_back(coldData);
+    storage.addedTicks.push_back(tick);
+    storage.changedTicks.emplace_back(tick);
+}
+
+std::pair<std::byte*, std::byte*> riaecs::ECSWorld::EraseFromStorage(size_t componentID, size_t entityIndex)
+{
+    // Swap with the last element and pop, so the dense arrays stay packed
+    ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.sparse[entityIndex];
+    size_t last = storage.entities.size() - 1;
+    std::pair<std::byte*, std::byte*> blocks(storage.data[position], storage.coldData[position]);
+
+    if (position != last)
+    {
+        storage.entities[position] = storage.entities[last];
+        storage.data[position] = storage.data[last];
+        storage.coldData[position] = storage.coldData[last];
+        storage.addedTicks[position] = storage.addedTicks[last];
+        storage.changedTicks[position] = storage.changedTicks[last];
+        storage.sparse[storage.entities[position].GetIndex()] = position;
+    }
+
+    storage.entities.pop_back();
+    storage.data.pop_back();
+    storage.coldData.pop_back();
+    storage.addedTicks.pop_back();
+    storage.changedTicks.pop_back();
+    storage.sparse[entityIndex] = NULL_POSITION;
+
+    return blocks;
+}
+
+void riaecs::ECSWorld::ReorderStorage(size_t componentID, const std::vector<size_t> &order)
+{
+    ComponentStorage &storage = componentStorages_[componentID];
+
+    std::vector<Entity> entities(order.size());
+    std::vector<std::byte*> data(order.size());
+    std::vector<std::byte*> coldData(order.size());
+    std::vector<uint64_t> addedTicks(order.size());
+    std::vector<AtomicTick> changedTicks(order.size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        entities[i] = storage.entities[order[i]];
+        data[i] = storage.data[order[i]];
+        coldData[i] = storage.coldData[order[i]];
+        addedTicks[i] = storage.addedTicks[order[i]];
+        changedTicks[i] = storage.changedTicks[order[i]];
+        storage.sparse[entities[i].GetIndex()] = i;
+    }
+
+    storage.entities.swap(entities);
+    storage.data.swap(data);
+    storage.coldData.swap(coldData);
+    storage.addedTicks.swap(addedTicks);
+    storage.changedTicks.swap(changedTicks);
+
+    if (componentGroups_[componentID] != NULL_POSITION)
+        RefreshGroup(componentGroups_[componentID]);
+}
+
+bool riaecs::ECSWorld::RelocateStorage(size_t componentID, std::chrono::steady_clock::time_point deadline)
+{
+    ComponentStorage &storage = componentStorages_[componentID];
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+
+    if (meta.isTag || meta.isShared)
+        return true; // Shared instances are referenced from many positions and have no dense order
+
+    if (!meta.isTriviallyCopyable && !meta.move)
+        return true; // Cannot be relocated, the order is still kept in the dense arrays
+
+    if (!SortBlocksByAddress(meta, storage.data, deadline))
+        return false;
+
+    if (meta.cold && (meta.cold->isTriviallyCopyable || meta.cold->move))
+        return SortBlocksByAddress(*meta.cold, storage.coldData, deadline);
+
+    return true;
+}
+
+bool riaecs::ECSWorld::CompactStorage(size_t componentID, std::chrono::steady_clock::time_point deadline)
+{
+    ComponentStorage &storage = componentStorages_[componentID];
+    auto isLess = [&storage](size_t a, size_t b)
+    {
+        return storage.entities[a].GetIndex() < storage.entities[b].GetIndex();
+    };
+
+    // The packed front of an owned storage is sorted on its own. Every owned storage holds the same
+    // members there, so they all end up in the same order
+    size_t groupSize = 0;
+    if (componentGroups_[componentID] != NULL_POSITION)
+        groupSize = groups_[componentGroups_[componentID]].data.size;
+
+    // Stable entity order first, then memory order follows the dense order
+    std::vector<size_t> order(storage.entities.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    if (!std::is_sorted(order.begin(), order.begin() + groupSize, isLess) || !std::is_sorted(order.begin() + groupSize, order.end(), isLess))
+    {
+        std::sort(order.begin(), order.begin() + groupSize, isLess);
+        std::sort(order.begin() + groupSize, order.end(), isLess);
+        ReorderStorage(componentID, order);
+    }
+
+    return RelocateStorage(componentID, deadline);
+}
+
+void riaecs::ECSWorld::SwapInStorage(size_t componentID, size_t positionA, size_t positionB)
+{
+    if (positionA == positionB)
+        return;
+
+    ComponentStorage &storage = componentStorages_[componentID];
+    std::swap(storage.entities[positionA], storage.entities[positionB]);
+    std::swap(storage.data[positionA], storage.data[positionB]);
+    std::swap(storage.coldData[positionA], storage.coldData[positionB]);
+    std::swap(storage.addedTicks[positionA], storage.addedTicks[positionB]);
+    std::swap(storage.changedTicks[positionA], storage.changedTicks[positionB]);
+    storage.sparse[storage.entities[positionA].GetIndex()] = positionA;
+    storage.sparse[storage.entities[positionB].GetIndex()] = positionB;
+}
+
+void riaecs::ECSWorld::EnterGroup(size_t groupID, size_t entityIndex)
+{
+    OwningGroup &group = groups_[groupID];
+    const uint64_t *signature = GetSignature(entityIndex);
+
+    bool hasAll = true;
+    for (size_t wordIndex = 0; wordIndex < signatureWordCount_ && hasAll; ++wordIndex)
+        hasAll = (signature[wordIndex] & group.mask[wordIndex]) == group.mask[wordIndex];
+
+    // Members are already in the front, which the first owned storage tells
+    if (hasAll && componentStorages_[group.data.componentIDs.front()].Find(entityIndex) >= group.data.size)
+    {
+        for (size_t componentID : group.data.componentIDs)
+            SwapInStorage(componentID, componentStorages_[componentID].sparse[entityIndex], group.data.size);
+
+        ++group.data.size;
+    }
+
+    // The insertion may have grown the dense arrays
+    RefreshGroup(groupID);
+}
+
+void riaecs::ECSWorld::LeaveGroup(size_t groupID, size_t entityIndex)
+{
+    OwningGroup &group = groups_[groupID];
+    if (componentStorages_[group.data.componentIDs.front()].Find(entityIndex) >= group.data.size)
+        return; // Not a member, NULL_POSITION included
+
+    // Swap with the last member so the front stays packed. The erase after this then moves
+    // only non-members
+    --group.data.size;
+    for (size_t componentID : group.data.componentIDs)
+        SwapInStorage(componentID, componentStorages_[componentID].sparse[entityIndex], group.data.size);
+}
+
+void riaecs::ECSWorld::RefreshGroup(size_t groupID)
+{
+    GroupData &data = groups_[groupID].data;
+    data.entities = componentStorages_[data.componentIDs.front()].entities.data();
+    for (size_t i = 0; i < data.componentIDs.size(); ++i)
+        data.columns[i] = componentStorages_[data.componentIDs[i]].data.data();
+}
+
+riaecs::Entity riaecs::ECSWorld::CreateEntity()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    return AllocateEntity();
+}
+
+void riaecs::ECSWorld::DestroyEntity(const Entity &entity)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    if (entity.GetIndex() >= entitySlots_.size())
+        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+
+    if (entitySlots_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
+        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+
+    if (!IsSlotAlive(entity.GetIndex()))
+        return; // Already destroyed this entity
+
+    ReleaseEntity(entity);
+}
+
+void riaecs::ECSWorld::CreateEntities(size_t count, const std::vector<size_t> &componentIDs, std::vector<Entity> &out)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    // Validate once for the whole batch
+    std::vector<bool> isListed(componentPools_.size(), false);
+    for (size_t componentID : componentIDs)
+    {
+        if (componentID >= componentPools_.size())
+            riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+        if (isListed[componentID])
+            riaecs::NotifyError({"Component ID is listed twice"}, RIAECS_LOG_LOC);
+        isListed[componentID] = true;
+
+        if (!componentMetas_[componentID].isTag && !componentMetas_[componentID].construct)
+            riaecs::NotifyError({"Component cannot be default constructed, emplace it instead"}, RIAECS_LOG_LOC);
+    }
+
+    // Grow the slot and signature tables once instead of per entity
+    entitySlots_.reserve(entitySlots_.size() + count);
+    signatures_.reserve((entitySlots_.size() + count) * signatureWordCount_);
+    out.reserve(out.size() + count);
+
+    for (size_t componentID : componentIDs)
+    {
+        ComponentStorage &storage = componentStorages_[componentID];
+        storage.entities.reserve(storage.entities.size() + count);
+        storage.data.reserve(storage.data.size() + count);
+        storage.coldData.reserve(storage.coldData.size() + count);
+        storage.addedTicks.reserve(storage.addedTicks.size() + count);
+        storage.changedTicks.reserve(storage.changedTicks.size() + count);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Entity entity = AllocateEntity();
+        try
+        {
+            for (size_t componentID : componentIDs)
+                AddComponentData(entity, componentID, nullptr, nullptr);
+        }
+        catch (...)
+        {
+            // A pool ran out part way, the entities already in out stay and this one goes away
+            ReleaseEntity(entity);
+            throw;
+        }
+
+        out.push_back(entity);
+    }
+}
+
+void riaecs::ECSWorld::DestroyEntities(const std::vector<Entity> &entities)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    // Validate the whole span first so a bad entity leaves every other one alive
+    for (const Entity &entity : entities)
+    {
+        if (entity.GetIndex() >= entitySlots_.size())
+            riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+
+        if (entitySlots_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
+            riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+    }
+
+    // Released slots keep their generation, so listing an entity twice only releases it once
+    for (const Entity &entity : entities)
+        if (IsSlotAlive(entity.GetIndex()))
+            ReleaseEntity(entity);
+}
+
+void riaecs::ECSWorld::Clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ReleaseAllComponents();
+
+    // Recreating the allocators frees every block of their pools at once
+    for (size_t i = 0; i < componentAllocators_.size(); ++i)
+    {
+        if (!componentAllocators_[i])
+            continue;
+
+        allocatorFactory_->Destroy(std::move(componentAllocators_[i]));
+        componentAllocators_[i] 
+        = allocatorFactory_->Create(*componentPools_[i], GetComponentBlockSize(componentMetas_[i]));
+
+        if (!coldAllocators_[i])
+            continue;
+
+        allocatorFactory_->Destroy(std::move(coldAllocators_[i]));
+        coldAllocators_[i] = allocatorFactory_->Create(*coldPools_[i], GetComponentBlockSize(*componentMetas_[i].cold));
+    }
+
+    // Link every slot into the free list, lowest index first, keeping the generations
+    freeSlotHead_ = riaecs::ENTITY_NULL_INDEX;
+    for (size_t index = entitySlots_.size(); index > 0; --index)
+    {
+        Entity &slot = entitySlots_[index - 1];
+        slot = Entity(freeSlotHead_, slot.GetGeneration());
+        freeSlotHead_ = index - 1;
+    }
+}
+
+void riaecs::ECSWorld::AddComponentObserver(size_t componentID, IComponentObserver &observer)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    if (componentID >= componentObservers_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    std::vector<IComponentObserver*> &observers = componentObservers_[componentID].observers;
+    if (std::find(observers.begin(), observers.end(), &observer) != observers.end())
+        riaecs::NotifyError({"Observer is already added to this component"}, RIAECS_LOG_LOC);
+
+    observers.push_back(&observer);
+}
+
+void riaecs::ECSWorld::RemoveComponentObserver(size_t componentID, IComponentObserver &observer)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (componentID >= componentObservers_.size())
+        return; // The world was destroyed, which already dropped the observers
+
+    ComponentObservers &entry = componentObservers_[componentID];
+    entry.observers.erase(std::remove(entry.observers.begin(), entry.observers.end(), &observer), entry.observers.end());
+
+    if (entry.observers.empty())
+        entry.events.clear();
+}
+
+void riaecs::ECSWorld::FlushObservers()
+{
+    struct Batch
+    {
+        size_t componentID;
+        std::vector<IComponentObserver*> observers;
+        std::vector<ComponentEvent> events;
+    };
+    std::vector<Batch> batches;
+
+    // Take the queued events under the lock and notify after releasing it
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+
+        for (size_t componentID = 0; componentID < componentObservers_.size(); ++componentID)
+        {
+            ComponentObservers &entry = componentObservers_[componentID];
+            if (entry.events.empty())
+                continue;
+
+            Batch batch;
+            batch.componentID = componentID;
+            batch.observers = entry.observers;
+            batch.events.swap(entry.events);
+            batches.push_back(std::move(batch));
+        }
+    }
+
+    // Consecutive events of the same kind go out as one batch, so a remove followed by an add
+    // of the same entity is seen in that order
+    std::vector<Entity> entities;
+    for (const Batch &batch : batches)
+    {
+        size_t begin = 0;
+        while (begin < batch.events.size())
+        {
+            bool isAdd = batch.events[begin].isAdd;
+            size_t end = begin;
+
+            entities.clear();
+            while (end < batch.events.size() && batch.events[end].isAdd == isAdd)
+                entities.push_back(batch.events[end++].entity);
+
+            for (IComponentObserver *observer : batch.observers)
+            {
+                if (isAdd)
+                    observer->OnAdd(*this, batch.componentID, entities);
+                else
+                    observer->OnRemove(*this, batch.componentID, entities);
+            }
+
+            begin = end;
+        }
+    }
+}
+
+riaecs::Prefab riaecs::ECSWorld::CreatePrefab(const Entity &entity) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    Prefab prefab;
+    const uint64_t *signature = GetSignature(entity.GetIndex());
+    for (size_t wordIndex = 0; wordIndex < signatureWordCount_; ++wordIndex)
+    {
+        for (uint64_t word = signature[wordIndex]; word != 0; word &= word - 1)
+        {
+            size_t componentID = wordIndex * 64 + CountTrailingZeros(word);
+            const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+
+            const ComponentStorage &storage = componentStorages_[componentID];
+            size_t position = storage.sparse[entity.GetIndex()];
+            prefab.Add(componentID, meta, storage.data[position], storage.coldData[position]);
+        }
+    }
+
+    return prefab;
+}
+
+void riaecs::ECSWorld::Instantiate(const Prefab &prefab, size_t count, std::vector<Entity> &out)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    for (size_t i = 0; i < prefab.GetComponentCount(); ++i)
+    {
+        const Prefab::Component &component = prefab.GetComponent(i);
+        if (component.componentID >= componentPools_.size())
+            riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+        // The prefab may come from another world with other component IDs
+        if (!IsLayoutCompatible(component.meta, componentMetas_[component.componentID]))
+            riaecs::NotifyError({"Prefab component does not match the registered component"}, RIAECS_LOG_LOC);
+    }
+
+    entitySlots_.reserve(entitySlots_.size() + count);
+    signatures_.reserve((entitySlots_.size() + count) * signatureWordCount_);
+    out.reserve(out.size() + count);
+
+    for (size_t i = 0; i < prefab.GetComponentCount(); ++i)
+    {
+        ComponentStorage &storage = componentStorages_[prefab.GetComponent(i).componentID];
+        storage.entities.reserve(storage.entities.size() + count);
+        storage.data.reserve(storage.data.size() + count);
+        storage.coldData.reserve(storage.coldData.size() + count);
+        storage.addedTicks.reserve(storage.addedTicks.size() + count);
+        storage.changedTicks.reserve(storage.changedTicks.size() + count);
+    }
+
+    // Copies the captured value, memcpy for trivially copyable types
+    ComponentConstructor copyFromPrefab = [](std::byte *data, void *context)
+    {
+        const Prefab::Component *component = static_cast<const Prefab::Component*>(context);
+        component->meta.Copy(data, component->data);
+    };
+
+    for (size_t instance = 0; instance < count; ++instance)
+    {
+        Entity entity = AllocateEntity();
+        try
+        {
+            for (size_t i = 0; i < prefab.GetComponentCount(); ++i)
+            {
+                const Prefab::Component &component = prefab.GetComponent(i);
+                AddComponentData
+                (
+                    entity, component.componentID, copyFromPrefab, const_cast<Prefab::Component*>(&component), 
+                    component.coldData
+                );
+            }
+        }
+        catch (...)
+        {
+            // The instances already in out stay, the half built one goes away
+            ReleaseEntity(entity);
+            throw;
+        }
+
+        out.push_back(entity);
+    }
+}
+
+size_t riaecs::ECSWorld::CreateRegisterIndex()
+{
+    return nextRegisterIndex_++;
+}
+
+void riaecs::ECSWorld::RegisterEntity(size_t index, const Entity &entity)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    if (registeredEntities_.find(index) != registeredEntities_.end())
+        riaecs::NotifyError({"Entity already registered at index: " + std::to_string(index)}, RIAECS_LOG_LOC);
+
+    registeredEntities_[index] = entity;
+}
+
+riaecs::Entity riaecs::ECSWorld::GetRegisteredEntity(size_t index) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    auto it = registeredEntities_.find(index);
+    if (it == registeredEntities_.end())
+        riaecs::NotifyError({"No entity registered at index: " + std::to_string(index)}, RIAECS_LOG_LOC);
+
+    return it->second;
+}
+
+void riaecs::ECSWorld::AddComponent(const Entity &entity, size_t componentID)
+{
+    AddComponent(entity, componentID, nullptr, nullptr);
+}
+
+void riaecs::ECSWorld::AddComponent
+(
+    const Entity &entity, size_t componentID, ComponentConstructor constructor, void *context
+){
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    AddComponentData(entity, componentID, constructor, context);
+}
+
+void riaecs::ECSWorld::AddComponentData
+(
+    const Entity &entity, size_t componentID, ComponentConstructor constructor, void *context, 
+    const std::byte *coldSource
+){
+    uint64_t *signature = GetSignature(entity.GetIndex());
+    if (TestSignature(signature, componentID))
+        riaecs::NotifyError({"Entity already has this component"}, RIAECS_LOG_LOC);
+
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+
+    // Tags are membership only, no allocation and no construction
+    if (meta.isTag)
+    {
+        signature[componentID / 64] |= uint64_t(1) << (componentID % 64);
+        InsertToStorage(componentID, entity, nullptr, nullptr);
+
+        if (componentGroups_[componentID] != NULL_POSITION)
+            EnterGroup(componentGroups_[componentID], entity.GetIndex());
+
+        if (!componentObservers_[componentID].observers.empty())
+            componentObservers_[componentID].events.push_back({entity, true});
+        return;
+    }
+
+    if (componentPools_[componentID] == nullptr || componentAllocators_[componentID] == nullptr)
+        riaecs::NotifyError({"Component pool or allocator not initialized for component ID"}, RIAECS_LOG_LOC);
+
+    if (!constructor && !meta.construct)
+        riaecs::NotifyError({"Component cannot be default constructed, emplace it instead"}, RIAECS_LOG_LOC);
+
+    // Shared values are built aside and only take a block when no equal instance exists,
+    // so the pool holds one block per distinct value
+    if (meta.isShared)
+    {
+        ScratchBlock value(meta);
+        if (constructor)
+            constructor(value.Get(), context);
+        else
+            meta.Construct(value.Get());
+
+        std::byte *instance = ShareValue(componentID, value.Get());
+
+        signature[componentID / 64] |= uint64_t(1) << (componentID % 64);
+        InsertToStorage(componentID, entity, instance, nullptr);
+
+        if (!componentObservers_[componentID].observers.empty())
+            componentObservers_[componentID].events.push_back({entity, true});
+        return;
+    }
+
+    // Allocate memory for the component using the allocator
+    size_t blockSize = GetComponentBlockSize(meta);
+    std::byte *componentPtr = componentAllocators_[componentID]->Malloc(blockSize, *componentPools_[componentID]);
+
+    if (!componentPtr)
+        riaecs::NotifyError({"Failed to allocate memory for component"}, RIAECS_LOG_LOC);
+
+    // Initialize the component, giving the block back if the constructor throws
+    if (constructor)
+    {
+        try
+        {
+            constructor(componentPtr, context);
+        }
+        catch (...)
+        {
+            componentAllocators_[componentID]->Free(componentPtr, *componentPools_[componentID]);
+            throw;
+        }
+    }
+    else
+        meta.Construct(componentPtr);
+
+    // The cold part is copied from coldSource or default constructed
+    std::byte *coldPtr = nullptr;
+    if (meta.cold)
+    {
+        size_t coldBlockSize = GetComponentBlockSize(*meta.cold);
+        coldPtr = coldAllocators_[componentID]->Malloc(coldBlockSize, *coldPools_[componentID]);
+
+        try
+        {
+            if (!coldPtr)
+                riaecs::NotifyError({"Failed to allocate memory for component"}, RIAECS_LOG_LOC);
+
+            if (coldSource)
+                meta.cold->Copy(coldPtr, coldSource);
+            else
+                meta.cold->Construct(coldPtr);
+        }
+        catch (...)
+        {
+            if (coldPtr)
+                coldAllocators_[componentID]->Free(coldPtr, *coldPools_[componentID]);
+
+            meta.Destroy(componentPtr);
+            componentAllocators_[componentID]->Free(componentPtr, *componentPools_[componentID]);
+            throw;
+        }
+    }
+
+    // Store to the signature and the storage
+    signature[componentID / 64] |= uint64_t(1) << (componentID % 64);
+    InsertToStorage(componentID, entity, componentPtr, coldPtr);
+
+    if (componentGroups_[componentID] != NULL_POSITION)
+        EnterGroup(componentGroups_[componentID], entity.GetIndex());
+
+    if (!componentObservers_[componentID].observers.empty())
+        componentObservers_[componentID].events.push_back({entity, true});
+}
+
+void riaecs::ECSWorld::RemoveComponent(const Entity &entity, size_t componentID)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    // Check if the entity has the component
+    uint64_t *signature = GetSignature(entity.GetIndex());
+    if (TestSignature(signature, componentID))
+    {
+        // Remove the component from the entity
+        signature[componentID / 64] &= ~(uint64_t(1) << (componentID % 64));
+        if (componentGroups_[componentID] != NULL_POSITION)
+            LeaveGroup(componentGroups_[componentID], entity.GetIndex());
+
+        std::pair<std::byte*, std::byte*> componentData = EraseFromStorage(componentID, entity.GetIndex());
+
+        if (!componentObservers_[componentID].observers.empty())
+            componentObservers_[componentID].events.push_back({entity, false});
+
+        // Free the component data which was allocated for this entity
+        FreeComponentData(componentID, componentData.first, componentData.second);
+    }
+}
+
+bool riaecs::ECSWorld::HasComponent(const Entity &entity, size_t componentID) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    return TestSignature(GetSignature(entity.GetIndex()), componentID);
+}
+
+riaecs::ReadOnlyObject<const std::byte*> riaecs::ECSWorld::GetComponent(const Entity &entity, size_t componentID)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    const ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.Find(entity.GetIndex());
+    if (position != NULL_POSITION)
+        return riaecs::ReadOnlyObject<const std::byte*>(std::move(lock), storage.data[position]);
+    
+    return riaecs::ReadOnlyObject<const std::byte*>(std::move(lock), nullptr);
+}
+
+riaecs::ReadOnlyObject<std::byte*> riaecs::ECSWorld::GetMutableComponent(const Entity &entity, size_t componentID)
 {
-    DestroyWorld();
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    if (componentMetas_[componentID].isShared)
+        riaecs::NotifyError({"Shared components are modified with ModifySharedComponent"}, RIAECS_LOG_LOC);
+
+    ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.Find(entity.GetIndex());
+    if (position == NULL_POSITION)
+        return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), nullptr);
+
+    storage.changedTicks[position].value.store(currentTick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), storage.data[position]);
 }
 
-void riaecs::ECSWorld::SetComponentFactoryRegistry(std::unique_ptr<IComponentFactoryRegistry> registry)
+riaecs::ReadOnlyObject<const std::byte*> riaecs::ECSWorld::GetColdComponent(const Entity &entity, size_t componentID)
 {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    componentFactoryRegistry_ = std::move(registry);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    if (!componentMetas_[componentID].cold)
+        riaecs::NotifyError({"Component is not split into hot and cold parts"}, RIAECS_LOG_LOC);
+
+    const ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.Find(entity.GetIndex());
+    if (position != NULL_POSITION)
+        return riaecs::ReadOnlyObject<const std::byte*>(std::move(lock), storage.coldData[position]);
+
+    return riaecs::ReadOnlyObject<const std::byte*>(std::move(lock), nullptr);
 }
 
-void riaecs::ECSWorld::SetPoolFactory(std::unique_ptr<IPoolFactory> poolFactory)
+riaecs::ReadOnlyObject<std::byte*> riaecs::ECSWorld::GetMutableColdComponent(const Entity &entity, size_t componentID)
 {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    poolFactory_ = std::move(poolFactory);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
+
+    ValidateEntity(entity);
+
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    if (!componentMetas_[componentID].cold)
+        riaecs::NotifyError({"Component is not split into hot and cold parts"}, RIAECS_LOG_LOC);
+
+    // Both parts share the component's changed tick
+    ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.Find(entity.GetIndex());
+    if (position == NULL_POSITION)
+        return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), nullptr);
+
+    storage.changedTicks[position].value.store(currentTick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), storage.coldData[position]);
 }
 
-void riaecs::ECSWorld::SetAllocatorFactory(std::unique_ptr<IAllocatorFactory> allocatorFactory)
+uint64_t riaecs::ECSWorld::GetTick() const
 {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    allocatorFactory_ = std::move(allocatorFactory);
+    return currentTick_.load(std::memory_order_relaxed);
 }
 
-void riaecs::ECSWorld::SetComponentMaxCountRegistry(std::unique_ptr<IComponentMaxCountRegistry> registry)
+uint64_t riaecs::ECSWorld::AdvanceTick()
 {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
-    componentMaxCountRegistry_ = std::move(registry);
+    return currentTick_.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
-bool riaecs::ECSWorld::IsReady() const
+std::vector<riaecs::Entity> riaecs::ECSWorld::CollectByTick(size_t componentID, uint64_t sinceTick, bool added) const
 {
     std::shared_lock<std::shared_mutex> lock(mutex_);
 
-    if (!componentFactoryRegistry_)
-    {
-        riaecs::NotifyError({"ComponentFactoryRegistry is not set"}, RIAECS_LOG_LOC);
-        isReady_ = false;
-        return isReady_;
-    }
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (!poolFactory_)
-    {
-        riaecs::NotifyError({"PoolFactory is not set"}, RIAECS_LOG_LOC);
-        isReady_ = false;
-        return isReady_;
-    }
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    if (!allocatorFactory_)
+    std::vector<Entity> result;
+    const ComponentStorage &storage = componentStorages_[componentID];
+    for (size_t i = 0; i < storage.entities.size(); ++i)
     {
-        riaecs::NotifyError({"AllocatorFactory is not set"}, RIAECS_LOG_LOC);
-        isReady_ = false;
-        return isReady_;
+        uint64_t tick = added ? storage.addedTicks[i] : storage.changedTicks[i].value.load(std::memory_order_relaxed);
+        if (tick > sinceTick)
+            result.push_back(storage.entities[i]);
     }
 
-    if (!componentMaxCountRegistry_)
-    {
-        riaecs::NotifyError({"ComponentMaxCountRegistry is not set"}, RIAECS_LOG_LOC);
-        isReady_ = false;
-        return isReady_;
-    }
+    return result;
+}
 
-    isReady_ = true;
-    return isReady_;
+std::vector<riaecs::Entity> riaecs::ECSWorld::Added(size_t componentID, uint64_t sinceTick) const
+{
+    return CollectByTick(componentID, sinceTick, true);
 }
 
-void riaecs::ECSWorld::CreateWorld()
+std::vector<riaecs::Entity> riaecs::ECSWorld::Changed(size_t componentID, uint64_t sinceTick) const
 {
-    if (!IsReady())
+    return CollectByTick(componentID, sinceTick, false);
+}
+
+riaecs::ReadOnlyObject<std::vector<riaecs::Entity>> riaecs::ECSWorld::View(size_t componentID) const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+    return riaecs::ReadOnlyObject<std::vector<riaecs::Entity>>(std::move(lock), componentStorages_[componentID].entities);
+}
+
+void riaecs::ECSWorld::Compact()
+{
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
-    // Initialize component pools and allocators
-    size_t componentCount = componentFactoryRegistry_->GetCount();
-    componentPools_.resize(componentCount);
-    componentAllocators_.resize(componentCount);
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    for (size_t i = 0; i < componentCount; ++i)
-    {
-        riaecs::ReadOnlyObject<IComponentFactory> factory = componentFactoryRegistry_->Get(i);
-        riaecs::ReadOnlyObject<size_t> maxCount = componentMaxCountRegistry_->Get(i);
+    for (size_t componentID = 0; componentID < componentStorages_.size(); ++componentID)
+        CompactStorage(componentID, std::chrono::steady_clock::time_point::max());
 
-        size_t blockSize = std::max(factory().GetProductSize(), riaecs::MAX_FREE_BLOCK_SIZE);
-        componentPools_[i] = poolFactory_->Create(blockSize * maxCount());
-        componentAllocators_[i] = allocatorFactory_->Create(*componentPools_[i], blockSize);
-    }
+    compactCursor_ = 0;
 }
 
-void riaecs::ECSWorld::DestroyWorld()
+bool riaecs::ECSWorld::Compact(std::chrono::microseconds budget)
 {
-    // Destroy all entities
-    for (size_t index = 0; index < entityExistFlags_.size(); ++index)
-        if (entityExistFlags_[index])
-            DestroyEntity(entities_[index]);
-
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
-    // Clear all component data
-    entityComponentToData_.clear();
-    entityToComponents_.clear();
-    componentToEntities_.clear();
+    if (!isReady_)
+        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    // Destroy pools and allocators
-    for (size_t i = 0; i < componentPools_.size(); ++i)
-        poolFactory_->Destroy(std::move(componentPools_[i]));
-    componentPools_.clear();
+    // A storage that runs past the deadline is left part way and picked up again next call
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + budget;
+    while (compactCursor_ < componentStorages_.size())
+    {
+        if (!CompactStorage(compactCursor_, deadline))
+            break;
 
-    for (size_t i = 0; i < componentAllocators_.size(); ++i)
-        allocatorFactory_->Destroy(std::move(componentAllocators_[i]));
-    componentAllocators_.clear();
+        ++compactCursor_;
+        if (std::chrono::steady_clock::now() >= deadline)
+            break;
+    }
 
-    // Reset entity management
-    entityExistFlags_.clear();
-    freeEntities_.clear();
+    if (compactCursor_ < componentStorages_.size())
+        return false;
 
-    // Reset ready state
-    isReady_ = false;
+    // Start over on the next call
+    compactCursor_ = 0;
+    return true;
 }
 
-riaecs::Entity riaecs::ECSWorld::CreateEntity()
+void riaecs::ECSWorld::SortComponent(size_t componentID, const ComponentComparator &less)
 {
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (!freeEntities_.empty())
-    {
-        Entity entity = freeEntities_.back();
-        freeEntities_.pop_back();
+    if (componentID >= componentStorages_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-        entityExistFlags_[entity.GetIndex()] = true;
-        entities_[entity.GetIndex()] = Entity(entity.GetIndex(), entity.GetGeneration() + 1);
+    if (componentGroups_[componentID] != NULL_POSITION)
+        riaecs::NotifyError({"Component is owned by a group and cannot be sorted"}, RIAECS_LOG_LOC);
 
-        return entities_[entity.GetIndex()];
-    }
-    else
+    const ComponentStorage &storage = componentStorages_[componentID];
+    std::vector<size_t> order(storage.entities.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+
+    std::stable_sort(order.begin(), order.end(), [&storage, &less](size_t a, size_t b)
     {
-        size_t index = entityExistFlags_.size();
-        entityExistFlags_.push_back(true);
-        entities_.push_back(Entity(index, riaecs::ID_DEFAULT_GENERATION));
+        return less(storage.entities[a], storage.data[a], storage.entities[b], storage.data[b]);
+    });
 
-        return entities_.back();
-    }
+    if (std::is_sorted(order.begin(), order.end()))
+        return; // Already in order, nothing moves
+
+    ReorderStorage(componentID, order);
+    RelocateStorage(componentID);
 }
 
-void riaecs::ECSWorld::DestroyEntity(const Entity &entity)
+void riaecs::ECSWorld::SortComponentLike(size_t componentID, size_t leaderComponentID)
 {
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (entity.GetIndex() >= entityExistFlags_.size())
-        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+    if (componentID >= componentStorages_.size() || leaderComponentID >= componentStorages_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    if (entities_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
-        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+    if (componentGroups_[componentID] != NULL_POSITION)
+        riaecs::NotifyError({"Component is owned by a group and cannot be sorted"}, RIAECS_LOG_LOC);
 
-    if (!entityExistFlags_[entity.GetIndex()])
-        return; // Already destroyed this entity
-    
-    // Remove all components associated with the entity
-    auto it = entityToComponents_.find(entity);
-    if (it != entityToComponents_.end())
-    {
-        for (size_t componentID : it->second)
-        {
-            // Remove the component from the entity
-            componentToEntities_[componentID].erase(entity);
+    if (componentID == leaderComponentID)
+        return;
 
-            // Get the component factory for the component ID
-            riaecs::ReadOnlyObject<riaecs::IComponentFactory> factory = componentFactoryRegistry_->Get(componentID);
+    const ComponentStorage &storage = componentStorages_[componentID];
+    const ComponentStorage &leader = componentStorages_[leaderComponentID];
 
-            // Free the component data which was allocated for this entity
-            std::byte *componentData = entityComponentToData_[{entity, componentID}];
-            factory().Destroy(componentData);
-            componentAllocators_[componentID]->Free(componentData, *componentPools_[componentID]);
-            entityComponentToData_.erase({entity, componentID});
-        }
+    std::vector<size_t> order;
+    order.reserve(storage.entities.size());
+
+    // Shared entities in the leader's order
+    std::vector<bool> isTaken(storage.entities.size(), false);
+    for (const Entity &entity : leader.entities)
+    {
+        size_t position = storage.Find(entity.GetIndex());
+        if (position == NULL_POSITION)
+            continue;
 
-        // Remove the entity from the entityToComponents map
-        entityToComponents_.erase(it);
+        order.push_back(position);
+        isTaken[position] = true;
     }
 
-    // Store the entity in freeEntities for reuse
-    freeEntities_.push_back(entity);
+    // The rest keep their relative order
+    for (size_t position = 0; position < storage.entities.size(); ++position)
+        if (!isTaken[position])
+            order.push_back(position);
 
-    // Update the entityExistFlags to mark it as not existing
-    entityExistFlags_[entity.GetIndex()] = false;
-}
+    if (std::is_sorted(order.begin(), order.end()))
+        return; // Already in order, nothing moves
 
-size_t riaecs::ECSWorld::CreateRegisterIndex()
-{
-    return nextRegisterIndex_++;
+    ReorderStorage(componentID, order);
+    RelocateStorage(componentID);
 }
 
-void riaecs::ECSWorld::RegisterEntity(size_t index, const Entity &entity)
+size_t riaecs::ECSWorld::CreateGroup(const std::vector<size_t> &ownedComponentIDs)
 {
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (registeredEntities_.find(index) != registeredEntities_.end())
-        riaecs::NotifyError({"Entity already registered at index: " + std::to_string(index)}, RIAECS_LOG_LOC);
+    if (ownedComponentIDs.empty())
+        riaecs::NotifyError({"Group needs at least one owned component"}, RIAECS_LOG_LOC);
 
-    registeredEntities_[index] = entity;
+    for (size_t i = 0; i < ownedComponentIDs.size(); ++i)
+    {
+        size_t componentID = ownedComponentIDs[i];
+        if (componentID >= componentStorages_.size())
+            riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+
+        if (componentGroups_[componentID] != NULL_POSITION)
+            riaecs::NotifyError({"Component is already owned by a group"}, RIAECS_LOG_LOC);
+
+        // Group iteration hands out writable references
+        if (componentMetas_[componentID].isShared)
+            riaecs::NotifyError({"Shared components cannot be owned by a group"}, RIAECS_LOG_LOC);
+
+        if (std::find(ownedComponentIDs.begin(), ownedComponentIDs.begin() + i, componentID) != ownedComponentIDs.begin() + i)
+            riaecs::NotifyError({"Component is listed twice in the group"}, RIAECS_LOG_LOC);
+    }
+
+    size_t groupID = groups_.size();
+    groups_.emplace_back();
+    OwningGroup &group = groups_.back();
+    group.mask = MakeSignatureMask(ownedComponentIDs, signatureWordCount_);
+    group.data.componentIDs = ownedComponentIDs;
+    group.data.columns.resize(ownedComponentIDs.size());
+
+    for (size_t componentID : ownedComponentIDs)
+        componentGroups_[componentID] = groupID;
+
+    // Pull in the existing members, walking the smallest owned storage
+    size_t smallestID = ownedComponentIDs.front();
+    for (size_t componentID : ownedComponentIDs)
+        if (componentStorages_[componentID].entities.size() < componentStorages_[smallestID].entities.size())
+            smallestID = componentID;
+
+    const std::vector<Entity> &candidates = componentStorages_[smallestID].entities;
+    for (size_t i = 0; i < candidates.size(); ++i)
+        EnterGroup(groupID, candidates[i].GetIndex());
+
+    RefreshGroup(groupID);
+    return groupID;
 }
 
-riaecs::Entity riaecs::ECSWorld::GetRegisteredEntity(size_t index) const
+riaecs::ReadOnlyObject<riaecs::GroupData> riaecs::ECSWorld::GetGroup(size_t groupID) const
 {
     std::shared_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    auto it = registeredEntities_.find(index);
-    if (it == registeredEntities_.end())
-        riaecs::NotifyError({"No entity registered at index: " + std::to_string(index)}, RIAECS_LOG_LOC);
+    if (groupID >= groups_.size())
+        riaecs::NotifyError({"Group ID out of range"}, RIAECS_LOG_LOC);
 
-    return it->second;
+    return riaecs::ReadOnlyObject<riaecs::GroupData>(std::move(lock), groups_[groupID].data);
 }
 
-void riaecs::ECSWorld::AddComponent(const Entity &entity, size_t componentID)
+riaecs::ReadOnlyObject<riaecs::GroupData> riaecs::ECSWorld::GetMutableGroup(size_t groupID)
 {
-    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (entity.GetIndex() >= entityExistFlags_.size())
-        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
-
-    if (!entityExistFlags_[entity.GetIndex()])
-        riaecs::NotifyError({"Entity does not exist"}, RIAECS_LOG_LOC);
-
-    if (entities_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
-        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
-
-    if (componentID >= componentPools_.size())
-        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
-
-    if (componentPools_[componentID] == nullptr || componentAllocators_[componentID] == nullptr)
-        riaecs::NotifyError({"Component pool or allocator not initialized for component ID"}, RIAECS_LOG_LOC);
-
-    if (entityToComponents_[entity].find(componentID) != entityToComponents_[entity].end())
-        riaecs::NotifyError({"Entity already has this component"}, RIAECS_LOG_LOC);
-
-    // Get the component factory for the component ID
-    riaecs::ReadOnlyObject<riaecs::IComponentFactory> factory = componentFactoryRegistry_->Get(componentID);
-
-    // Allocate memory for the component using the allocator
-    size_t blockSize = std::max(factory().GetProductSize(), riaecs::MAX_FREE_BLOCK_SIZE);
-    std::byte *componentPtr = componentAllocators_[componentID]->Malloc(blockSize, *componentPools_[componentID]);
-
-    if (!componentPtr)
-        riaecs::NotifyError({"Failed to allocate memory for component"}, RIAECS_LOG_LOC);
+    if (groupID >= groups_.size())
+        riaecs::NotifyError({"Group ID out of range"}, RIAECS_LOG_LOC);
 
-    // Initialize the component using the factory
-    componentPtr = factory().Create(componentPtr);
+    // Members are the packed front of every owned storage
+    const riaecs::GroupData &data = groups_[groupID].data;
+    uint64_t tick = currentTick_.load(std::memory_order_relaxed);
+    for (size_t componentID : data.componentIDs)
+    {
+        ComponentStorage &storage = componentStorages_[componentID];
+        for (size_t i = 0; i < data.size; ++i)
+            storage.changedTicks[i].value.store(tick, std::memory_order_relaxed);
+    }
 
-    // Store to the maps
-    entityToComponents_[entity].insert(componentID);
-    componentToEntities_[componentID].insert(entity);
-    entityComponentToData_[{entity, componentID}] = componentPtr;
+    return riaecs::ReadOnlyObject<riaecs::GroupData>(std::move(lock), data);
 }
 
-void riaecs::ECSWorld::RemoveComponent(const Entity &entity, size_t componentID)
-{
+void riaecs::ECSWorld::ModifySharedComponent
+(
+    const Entity &entity, size_t componentID, ComponentModifier modifier, void *context
+){
     std::unique_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (entity.GetIndex() >= entityExistFlags_.size())
-        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
-
-    if (!entityExistFlags_[entity.GetIndex()])
-        riaecs::NotifyError({"Entity does not exist"}, RIAECS_LOG_LOC);
-
-    if (entities_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
-        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+    ValidateEntity(entity);
 
     if (componentID >= componentPools_.size())
         riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    // Check if the entity has the component
-    auto it = entityToComponents_.find(entity);
-    if (it != entityToComponents_.end() && it->second.find(componentID) != it->second.end())
+    const riaecs::ComponentMeta &meta = componentMetas_[componentID];
+    if (!meta.isShared)
+        riaecs::NotifyError({"Component is not shared"}, RIAECS_LOG_LOC);
+
+    ComponentStorage &storage = componentStorages_[componentID];
+    size_t position = storage.Find(entity.GetIndex());
+    if (position == NULL_POSITION)
+        riaecs::NotifyError({"Entity does not have this component"}, RIAECS_LOG_LOC);
+
+    std::byte *data = storage.data[position];
+    SharedInstances &instances = sharedInstances_[componentID];
+    if (instances.entries.at(data).refCount == 1)
     {
-        // Remove the component from the entity
-        it->second.erase(componentID);
-        componentToEntities_[componentID].erase(entity);
+        // The only reference is modified in place, out of the index while its value changes.
+        // It is shared again even if the modifier throws, so the block is always owned by the index
+        UnindexInstance(componentID, data);
+        instances.entries.erase(data);
+
+        try
+        {
+            modifier(data, context);
+        }
+        catch (...)
+        {
+            storage.data[position] = ShareInstance(componentID, data);
+            throw;
+        }
 
-        // Get the component factory for the component ID
-        riaecs::ReadOnlyObject<riaecs::IComponentFactory> factory = componentFactoryRegistry_->Get(componentID);
+        storage.data[position] = ShareInstance(componentID, data);
+    }
+    else
+    {
+        // The entity gets its own copy, which only takes a block if the new value is new
+        ScratchBlock value(meta);
+        meta.Copy(value.Get(), data);
 
-        // Free the component data which was allocated for this entity
-        std::byte *componentData = entityComponentToData_[{entity, componentID}];
-        factory().Destroy(componentData);
-        componentAllocators_[componentID]->Free(componentData, *componentPools_[componentID]);
-        entityComponentToData_.erase({entity, componentID});
+        try
+        {
+            modifier(value.Get(), context);
+        }
+        catch (...)
+        {
+            meta.Destroy(value.Get());
+            throw;
+        }
+
+        std::byte *instance = ShareValue(componentID, value.Get());
+        --instances.entries.at(data).refCount;
+        storage.data[position] = instance;
     }
+
+    storage.changedTicks[position].value.store(currentTick_.load(std::memory_order_relaxed), std::memory_order_relaxed);
 }
 
-bool riaecs::ECSWorld::HasComponent(const Entity &entity, size_t componentID) const
+std::vector<riaecs::SharedGroup> riaecs::ECSWorld::GroupByShared(size_t componentID) const
 {
     std::shared_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (entity.GetIndex() >= entityExistFlags_.size())
-        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+    if (componentID >= componentPools_.size())
+        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    if (!entityExistFlags_[entity.GetIndex()])
-        riaecs::NotifyError({"Entity does not exist"}, RIAECS_LOG_LOC);
+    if (!componentMetas_[componentID].isShared)
+        riaecs::NotifyError({"Component is not shared"}, RIAECS_LOG_LOC);
 
-    if (entities_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
-        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+    std::vector<riaecs::SharedGroup> groups;
+    groups.reserve(sharedInstances_[componentID].entries.size());
 
-    if (componentID >= componentPools_.size())
-        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+    std::unordered_map<const std::byte*, size_t> groupIndices;
+    const ComponentStorage &storage = componentStorages_[componentID];
+    for (size_t position = 0; position < storage.entities.size(); ++position)
+    {
+        auto [it, isNew] = groupIndices.try_emplace(storage.data[position], groups.size());
+        if (isNew)
+        {
+            groups.emplace_back();
+            groups.back().data = storage.data[position];
+            groups.back().entities.reserve(sharedInstances_[componentID].entries.at(storage.data[position]).refCount);
+        }
+
+        groups[it->second].entities.push_back(storage.entities[position]);
+    }
 
-    auto it = entityToComponents_.find(entity);
-    return it != entityToComponents_.end() && it->second.find(componentID) != it->second.end();
+    return groups;
 }
 
-riaecs::ReadOnlyObject<std::byte*> riaecs::ECSWorld::GetComponent(const Entity &entity, size_t componentID)
-{
+std::vector<riaecs::Entity> riaecs::ECSWorld::Query
+(
+    const std::vector<size_t> &includeIDs, const std::vector<size_t> &excludeIDs
+) const {
     std::shared_lock<std::shared_mutex> lock(mutex_);
 
     if (!isReady_)
         riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
 
-    if (entity.GetIndex() >= entityExistFlags_.size())
-        riaecs::NotifyError({"Entity index out of range"}, RIAECS_LOG_LOC);
+    if (includeIDs.empty())
+        riaecs::NotifyError({"Query needs at least one included component"}, RIAECS_LOG_LOC);
 
-    if (!entityExistFlags_[entity.GetIndex()])
-        riaecs::NotifyError({"Entity does not exist"}, RIAECS_LOG_LOC);
+    for (size_t componentID : includeIDs)
+        if (componentID >= componentPools_.size())
+            riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    if (entities_[entity.GetIndex()].GetGeneration() != entity.GetGeneration())
-        riaecs::NotifyError({"Entity generation mismatch"}, RIAECS_LOG_LOC);
+    for (size_t componentID : excludeIDs)
+        if (componentID >= componentPools_.size())
+            riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    if (componentID >= componentPools_.size())
-        riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
+    std::vector<uint64_t> includeMask = MakeSignatureMask(includeIDs, signatureWordCount_);
+    std::vector<uint64_t> excludeMask = MakeSignatureMask(excludeIDs, signatureWordCount_);
 
-    auto it = entityComponentToData_.find({entity, componentID});
-    if (it != entityComponentToData_.end())
-        return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), it->second);
-    
-    return riaecs::ReadOnlyObject<std::byte*>(std::move(lock), nullptr);
+    // Walk the smallest member set and match the rest against the signatures
+    const std::vector<Entity> *candidates = &componentStorages_[includeIDs.front()].entities;
+    for (size_t componentID : includeIDs)
+    {
+        const std::vector<Entity> &entities = componentStorages_[componentID].entities;
+        if (entities.size() < candidates->size())
+            candidates = &entities;
+    }
+
+    std::vector<Entity> result;
+    for (const Entity &entity : *candidates)
+    {
+        const uint64_t *signature = GetSignature(entity.GetIndex());
+
+        bool matched = true;
+        for (size_t wordIndex = 0; wordIndex < signatureWordCount_ && matched; ++wordIndex)
+        {
+            matched 
+            = (signature[wordIndex] & includeMask[wordIndex]) == includeMask[wordIndex] 
+            && (signature[wordIndex] & excludeMask[wordIndex]) == 0;
+        }
+
+        if (matched)
+            result.push_back(entity);
+    }
+
+    return result;
 }
 
-riaecs::ReadOnlyObject<std::unordered_set<riaecs::Entity>> riaecs::ECSWorld::View(size_t componentID) const
+const riaecs::ComponentMeta &riaecs::ECSWorld::GetComponentMeta(size_t componentID) const
 {
     std::shared_lock<std::shared_mutex> lock(mutex_);
 
-    if (!isReady_)
-        riaecs::NotifyError({"ECSWorld is not ready"}, RIAECS_LOG_LOC);
-
-    if (componentID >= componentPools_.size())
+    if (componentID >= componentMetas_.size())
         riaecs::NotifyError({"Component ID out of range"}, RIAECS_LOG_LOC);
 
-    auto it = componentToEntities_.find(componentID);
-    if (it != componentToEntities_.end())
-        return riaecs::ReadOnlyObject<std::unordered_set<riaecs::Entity>>(std::move(lock), it->second);
-
-    return riaecs::ReadOnlyObject<std::unordered_set<riaecs::Entity>>(std::move(lock), emptyEntities_);
+    return componentMetas_[componentID];
 }
 
 riaecs::SystemList::~SystemList()
@@ -564,8 +2098,14 @@ void riaecs::SystemLoop::Run(IECSWorld &world, IAssetContainer &assetCont)
         bool continueLoop = true;
         for (size_t i = 0; i < systemList_->GetCount(); ++i)
         {
+            // Each system runs at its own tick, so it sees the writes of every system that ran after it
+            world.AdvanceTick();
+
             ISystem &system = systemList_->Get(i);
             continueLoop = system.Update(world, assetCont, *commandQueue_);
+
+            // Deliver the structural changes the system made as one batch per component
+            world.FlushObservers();
             if (!continueLoop)
                 break; // Stop the system update if any system returns false
         }
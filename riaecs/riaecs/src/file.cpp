@@ -0,0 +1,244 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/file.h"
+
+#include "riaecs/include/utilities.h"
+
+namespace
+{
+    constexpr size_t NO_BUFFER_INDEX = static_cast<size_t>(-1);
+
+} // namespace
+
+riaecs::ByteBufferPool::ByteBufferPool(size_t maxFreeBufferCount) : MAX_FREE_BUFFER_COUNT_(maxFreeBufferCount)
+{
+}
+
+riaecs::ByteBuffer riaecs::ByteBufferPool::Acquire(size_t size)
+{
+    ByteBuffer buffer;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto bestIt = freeBuffers_.end();
+        for (auto it = freeBuffers_.begin(); it != freeBuffers_.end(); ++it)
+        {
+            if (it->capacity() < size)
+                continue;
+
+            if (bestIt == freeBuffers_.end() || it->capacity() < bestIt->capacity())
+                bestIt = it;
+        }
+
+        if (bestIt != freeBuffers_.end())
+        {
+            buffer = std::move(*bestIt);
+            freeBuffers_.erase(bestIt);
+        }
+    }
+
+    buffer.resize(size); // Within capacity this only sets the size
+    return buffer;
+}
+
+void riaecs::ByteBufferPool::Release(ByteBuffer buffer)
+{
+    if (buffer.capacity() == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (freeBuffers_.size() >= MAX_FREE_BUFFER_COUNT_)
+        return;
+
+    buffer.clear();
+    freeBuffers_.emplace_back(std::move(buffer));
+}
+
+size_t riaecs::ByteBufferPool::GetFreeCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return freeBuffers_.size();
+}
+
+riaecs::MemoryFileData::~MemoryFileData()
+{
+    if (pool_)
+        pool_->Release(std::move(pooledBytes_));
+}
+
+riaecs::FileStream::FileStream(std::string_view filePath)
+{
+    file_.open(std::string(filePath), std::ios::binary | std::ios::ate);
+    if (!file_.is_open())
+        riaecs::NotifyError({"Failed to open file: " + std::string(filePath)}, RIAECS_LOG_LOC);
+
+    size_ = static_cast<size_t>(file_.tellg());
+}
+
+size_t riaecs::FileStream::Read(size_t offset, std::byte *buffer, size_t size)
+{
+    if (offset >= size_)
+        return 0;
+
+    size = std::min(size, size_ - offset);
+
+    file_.clear();
+    file_.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    file_.read(reinterpret_cast<char*>(buffer), static_cast<std::streamsize>(size));
+
+    return static_cast<size_t>(file_.gcount());
+}
+
+std::unique_ptr<riaecs::IFileData> riaecs::BinaryFileLoader::Load(std::string_view filePath) const
+{
+    riaecs::FileStream stream(filePath);
+
+    if (memory_)
+    {
+        riaecs::AssetMemoryBlock block(*memory_, stream.GetSize());
+        if (stream.Read(0, block.GetData(), block.GetSize()) != block.GetSize())
+            riaecs::NotifyError({"Failed to read file: " + std::string(filePath)}, RIAECS_LOG_LOC);
+
+        return std::make_unique<riaecs::MemoryFileData>(std::move(block));
+    }
+
+    std::vector<std::byte> bytes(stream.GetSize());
+    if (stream.Read(0, bytes.data(), bytes.size()) != bytes.size())
+        riaecs::NotifyError({"Failed to read file: " + std::string(filePath)}, RIAECS_LOG_LOC);
+
+    return std::make_unique<riaecs::MemoryFileData>(std::move(bytes));
+}
+
+std::unique_ptr<riaecs::IFileStream> riaecs::BinaryFileLoader::Open(std::string_view filePath) const
+{
+    return std::make_unique<riaecs::FileStream>(filePath);
+}
+
+riaecs::FileChunkReader::FileChunkReader
+(
+    std::unique_ptr<IFileStream> stream, size_t chunkSize, size_t maxBufferedChunkCount
+) : stream_(std::move(stream)), CHUNK_SIZE_(chunkSize), consumingBufferIndex_(NO_BUFFER_INDEX)
+{
+    if (!stream_)
+        riaecs::NotifyError({"Stream cannot be null"}, RIAECS_LOG_LOC);
+
+    if (CHUNK_SIZE_ == 0 || maxBufferedChunkCount == 0)
+        riaecs::NotifyError({"Chunk size and buffered chunk count must be greater than zero"}, RIAECS_LOG_LOC);
+
+    // One more buffer is held by the consumer while the others are read ahead
+    size_t bufferCount = maxBufferedChunkCount + 1;
+    buffers_.resize(bufferCount);
+    for (size_t i = 0; i < bufferCount; ++i)
+    {
+        buffers_[i] = std::make_unique<std::byte[]>(CHUNK_SIZE_);
+        freeBufferIndices_.push_back(i);
+    }
+
+    readThread_ = std::thread(&FileChunkReader::ReadLoop, this);
+}
+
+riaecs::FileChunkReader::~FileChunkReader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopping_ = true;
+    }
+    freeCondition_.notify_all();
+
+    if (readThread_.joinable())
+        readThread_.join();
+}
+
+void riaecs::FileChunkReader::ReadLoop()
+{
+    size_t offset = 0;
+    size_t fileSize = stream_->GetSize();
+
+    while (offset < fileSize)
+    {
+        size_t bufferIndex = NO_BUFFER_INDEX;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            freeCondition_.wait(lock, [this]() { return isStopping_ || !freeBufferIndices_.empty(); });
+
+            if (isStopping_)
+                return;
+
+            bufferIndex = freeBufferIndices_.back();
+            freeBufferIndices_.pop_back();
+        }
+
+        // Read without holding the lock so that the consumer can decode the previous chunks
+        size_t readSize = 0;
+        try
+        {
+            std::lock_guard<std::mutex> streamLock(streamMutex_);
+            readSize = stream_->Read(offset, buffers_[bufferIndex].get(), std::min(CHUNK_SIZE_, fileSize - offset));
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            error_ = std::current_exception();
+            break;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (readSize == 0)
+            {
+                freeBufferIndices_.push_back(bufferIndex);
+                break; // The file is shorter than reported
+            }
+
+            filledChunks_.push({bufferIndex, readSize});
+        }
+        filledCondition_.notify_one();
+
+        offset += readSize;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isReadEnd_ = true;
+    }
+    filledCondition_.notify_all();
+}
+
+bool riaecs::FileChunkReader::Next(const std::byte *&data, size_t &size)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Recycle the chunk returned by the previous call
+    if (consumingBufferIndex_ != NO_BUFFER_INDEX)
+    {
+        freeBufferIndices_.push_back(consumingBufferIndex_);
+        consumingBufferIndex_ = NO_BUFFER_INDEX;
+        freeCondition_.notify_one();
+    }
+
+    filledCondition_.wait(lock, [this]() { return !filledChunks_.empty() || isReadEnd_; });
+
+    if (filledChunks_.empty())
+    {
+        if (error_)
+            std::rethrow_exception(error_);
+
+        data = nullptr;
+        size = 0;
+        return false;
+    }
+
+    FilledChunk chunk = filledChunks_.front();
+    filledChunks_.pop();
+
+    consumingBufferIndex_ = chunk.bufferIndex;
+    data = buffers_[chunk.bufferIndex].get();
+    size = chunk.size;
+    return true;
+}
+
+size_t riaecs::FileChunkReader::ReadRange(size_t offset, std::byte *buffer, size_t size)
+{
+    std::lock_guard<std::mutex> streamLock(streamMutex_);
+    return stream_->Read(offset, buffer, size);
+}
\ No newline at end of file
@@ -7,12 +7,23 @@
 #include <iostream>
 #include <initializer_list>
 #include <shared_mutex>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #include <string>
 #include <string_view>
+#include <optional>
+#include <future>
+#include <functional>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
 
 #include <memory>
 #include <vector>
+#include <map>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
\ No newline at end of file
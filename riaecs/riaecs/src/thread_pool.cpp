@@ -0,0 +1,71 @@
+﻿#include "riaecs/src/pch.h"
+#include "riaecs/include/thread_pool.h"
+
+#include "riaecs/include/utilities.h"
+
+riaecs::ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    workers_.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+riaecs::ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopping_ = true;
+    }
+    taskCondition_.notify_all();
+
+    for (std::thread &worker : workers_)
+        if (worker.joinable())
+            worker.join();
+}
+
+void riaecs::ThreadPool::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (true)
+    {
+        taskCondition_.wait(lock, [this]() { return isStopping_ || !tasks_.empty(); });
+
+        // Run the remaining tasks even when stopping
+        if (tasks_.empty() && isStopping_)
+            break;
+
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop();
+        runningCount_++;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        runningCount_--;
+        if (tasks_.empty() && runningCount_ == 0)
+            idleCondition_.notify_all();
+    }
+}
+
+void riaecs::ThreadPool::Submit(std::function<void()> task)
+{
+    if (!task)
+        riaecs::NotifyError({"Task cannot be null"}, RIAECS_LOG_LOC);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.emplace(std::move(task));
+    }
+    taskCondition_.notify_one();
+}
+
+void riaecs::ThreadPool::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCondition_.wait(lock, [this]() { return tasks_.empty() && runningCount_ == 0; });
+}
\ No newline at end of file
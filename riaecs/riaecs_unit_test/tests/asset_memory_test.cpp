@@ -0,0 +1,65 @@
+﻿#include "riaecs_unit_test/pch.h"
+
+#include "riaecs/include/asset_memory.h"
+#pragma comment(lib, "riaecs.lib")
+
+#include "mem_alloc_fixed_block/mem_alloc_fixed_block.h"
+#pragma comment(lib, "mem_alloc_fixed_block.lib")
+
+TEST(AssetMemory, Allocate)
+{
+    const size_t CHUNK_SIZE = 4096;
+    const size_t MAX_BLOCK_SIZE = 1024;
+    riaecs::AssetMemory memory
+    (
+        std::make_unique<mem_alloc_fixed_block::FixedBlockPoolFactory>(),
+        std::make_unique<mem_alloc_fixed_block::FixedBlockAllocatorFactory>(),
+        CHUNK_SIZE, MAX_BLOCK_SIZE
+    );
+
+    // Sizes are rounded up to their size class, classes share nothing
+    std::byte *small = memory.Malloc(10);
+    std::byte *medium = memory.Malloc(100);
+    EXPECT_EQ(memory.GetUsedSize(), 16 + 128);
+    EXPECT_EQ(memory.GetPoolCount(), 2);
+
+    // Freed blocks are reused by the next allocation of the class
+    memory.Free(small);
+    EXPECT_EQ(memory.Malloc(16), small);
+
+    // A full chunk adds another pool of the class
+    std::vector<std::byte*> blocks;
+    for (size_t i = 0; i < CHUNK_SIZE / 128; ++i)
+        blocks.push_back(memory.Malloc(128));
+    EXPECT_EQ(memory.GetPoolCount(), 3);
+
+    // Large requests get a pool of their own which is released on free
+    std::byte *large = memory.Malloc(MAX_BLOCK_SIZE + 1);
+    EXPECT_EQ(memory.GetPoolCount(), 4);
+    memory.Free(large);
+    EXPECT_EQ(memory.GetPoolCount(), 3);
+
+    // Blocks free themselves
+    {
+        riaecs::AssetMemoryBlock block(memory, 500);
+        EXPECT_NE(block.GetData(), nullptr);
+        EXPECT_EQ(block.GetSize(), 500);
+
+        riaecs::AssetMemoryBlock moved = std::move(block);
+        EXPECT_EQ(block.GetData(), nullptr);
+        EXPECT_EQ(moved.GetSize(), 500);
+    }
+
+    memory.Free(small);
+    memory.Free(medium);
+
+    // Everything goes back in bulk, including the blocks still in use
+    EXPECT_NE(memory.GetUsedSize(), 0);
+    memory.Reset();
+    EXPECT_EQ(memory.GetUsedSize(), 0);
+    EXPECT_EQ(memory.GetPoolCount(), 0);
+    blocks.clear();
+
+    std::byte notAllocated[16];
+    EXPECT_THROW(memory.Free(notAllocated), std::runtime_error);
+}
\ No newline at end of file
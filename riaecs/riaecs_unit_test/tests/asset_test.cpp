@@ -1,9 +1,27 @@
 ﻿#include "riaecs_unit_test/pch.h"
 
 #include "riaecs/include/asset.h"
+#include "riaecs/include/asset_loader.h"
+#include "riaecs/include/file.h"
+#include "riaecs/include/asset_watcher.h"
+#include "riaecs/include/compression.h"
+#include "riaecs/include/asset_memory.h"
+#include "riaecs/include/asset_profiler.h"
 #include "riaecs/include/global_registry.h"
 #pragma comment(lib, "riaecs.lib")
 
+#include "mem_alloc_fixed_block/mem_alloc_fixed_block.h"
+#pragma comment(lib, "mem_alloc_fixed_block.lib")
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
 namespace
 {
     class TestFileData : public riaecs::IFileData
@@ -41,6 +59,21 @@ namespace
     };
     riaecs::FileLoaderRegistrar<TestFileLoader> TestFileLoaderID;
 
+    class CountingFileLoader : public riaecs::IFileLoader
+    {
+    public:
+        mutable std::atomic<int> loadCount = 0;
+
+        std::unique_ptr<riaecs::IFileData> Load(std::string_view filePath) const override
+        {
+            loadCount++;
+
+            // Give the other threads time to join the in-flight load
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return std::make_unique<TestFileData>();
+        }
+    };
+
     constexpr int INITIAL_ASSET_VALUE = 10;
     class TestAsset : public riaecs::IAsset
     {
@@ -107,6 +140,177 @@ namespace
     };
     riaecs::AssetFactoryRegistrar<TestAssetFactory> TestAssetFactoryID;
 
+    class PathFileData : public riaecs::IFileData
+    {
+    public:
+        std::string path;
+        PathFileData(std::string_view filePath) : path(filePath) {}
+    };
+
+    class PathFileLoader : public riaecs::IFileLoader
+    {
+    public:
+        std::unique_ptr<riaecs::IFileData> Load(std::string_view filePath) const override
+        {
+            return std::make_unique<PathFileData>(filePath);
+        }
+    };
+
+    // Blocks in Load until the gate is opened
+    class GatedFileLoader : public riaecs::IFileLoader
+    {
+    public:
+        mutable std::atomic<bool> isOpen = false;
+
+        std::unique_ptr<riaecs::IFileData> Load(std::string_view filePath) const override
+        {
+            while (!isOpen)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+            return std::make_unique<PathFileData>(filePath);
+        }
+    };
+
+    // Records the order in which assets are created
+    class RecordingAssetFactory : public riaecs::IAssetFactory
+    {
+    public:
+        mutable std::mutex mutex;
+        mutable std::vector<std::string> createdPaths;
+
+        std::unique_ptr<riaecs::IAssetStagingArea> Prepare() const override
+        {
+            return std::make_unique<TestAssetStagingArea>();
+        }
+
+        std::unique_ptr<riaecs::IAsset> Create
+        (
+            const riaecs::IFileData &fileData, riaecs::IAssetStagingArea &stagingArea
+        ) const override
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            createdPaths.push_back(dynamic_cast<const PathFileData&>(fileData).path);
+            return std::make_unique<TestAsset>();
+        }
+
+        void Commit(riaecs::IAssetStagingArea &stagingArea) const override {}
+    };
+
+    class ByteSumAsset : public riaecs::IAsset
+    {
+    public:
+        size_t sum = 0;
+        size_t maxChunkSize = 0;
+    };
+
+    // Sums the bytes of the file, either from the whole file data or while streaming
+    class ByteSumAssetFactory : public riaecs::IAssetFactory, public riaecs::IStreamingAssetFactory
+    {
+    public:
+        static constexpr size_t CHUNK_SIZE = 256;
+
+        std::unique_ptr<riaecs::IAssetStagingArea> Prepare() const override
+        {
+            return std::make_unique<TestAssetStagingArea>();
+        }
+
+        std::unique_ptr<riaecs::IAsset> Create
+        (
+            const riaecs::IFileData &fileData, riaecs::IAssetStagingArea &stagingArea
+        ) const override
+        {
+            const riaecs::MemoryFileData &memoryData = dynamic_cast<const riaecs::MemoryFileData&>(fileData);
+
+            std::unique_ptr<ByteSumAsset> asset = std::make_unique<ByteSumAsset>();
+            for (size_t i = 0; i < memoryData.GetSize(); ++i)
+                asset->sum += static_cast<size_t>(memoryData.GetData()[i]);
+
+            asset->maxChunkSize = memoryData.GetSize();
+            return asset;
+        }
+
+        std::unique_ptr<riaecs::IAsset> CreateFromStream
+        (
+            riaecs::IFileChunkReader &chunkReader, riaecs::IAssetStagingArea &stagingArea
+        ) const override
+        {
+            std::unique_ptr<ByteSumAsset> asset = std::make_unique<ByteSumAsset>();
+
+            const std::byte *data = nullptr;
+            size_t size = 0;
+            while (chunkReader.Next(data, size))
+            {
+                for (size_t i = 0; i < size; ++i)
+                    asset->sum += static_cast<size_t>(data[i]);
+
+                asset->maxChunkSize = std::max(asset->maxChunkSize, size);
+            }
+
+            return asset;
+        }
+
+        void Commit(riaecs::IAssetStagingArea &stagingArea) const override {}
+
+        size_t GetChunkSize() const override { return CHUNK_SIZE; }
+    };
+
+    class SizedStagingArea : public riaecs::IAssetStagingArea
+    {
+    public:
+        static constexpr size_t SIZE = 64;
+        size_t GetSize() const override { return SIZE; }
+    };
+
+    class StagedByteSumAssetFactory : public ByteSumAssetFactory
+    {
+    public:
+        std::unique_ptr<riaecs::IAssetStagingArea> Prepare() const override
+        {
+            return std::make_unique<SizedStagingArea>();
+        }
+    };
+
+    // Keeps a copy of the file in asset memory
+    class MemoryBlockAsset : public riaecs::IAsset
+    {
+    public:
+        riaecs::AssetMemoryBlock block;
+    };
+
+    class MemoryBlockAssetFactory : public riaecs::IAssetFactory
+    {
+    public:
+        std::unique_ptr<riaecs::IAssetStagingArea> Prepare() const override
+        {
+            return std::make_unique<TestAssetStagingArea>();
+        }
+
+        std::unique_ptr<riaecs::IAsset> Create
+        (
+            const riaecs::IFileData &fileData, riaecs::IAssetStagingArea &stagingArea
+        ) const override
+        {
+            riaecs::NotifyError({"MemoryBlockAssetFactory requires asset memory"}, RIAECS_LOG_LOC);
+            return nullptr;
+        }
+
+        std::unique_ptr<riaecs::IAsset> CreateWithMemory
+        (
+            const riaecs::IFileData &fileData, riaecs::IAssetStagingArea &stagingArea, riaecs::IAssetMemory &memory
+        ) const override
+        {
+            const riaecs::MemoryFileData &memoryData = dynamic_cast<const riaecs::MemoryFileData&>(fileData);
+
+            std::unique_ptr<MemoryBlockAsset> asset = std::make_unique<MemoryBlockAsset>();
+            asset->block = riaecs::AssetMemoryBlock(memory, memoryData.GetSize());
+            std::memcpy(asset->block.GetData(), memoryData.GetData(), memoryData.GetSize());
+
+            return asset;
+        }
+
+        void Commit(riaecs::IAssetStagingArea &stagingArea) const override {}
+    };
+
     riaecs::AssetSourceRegistrar TestAssetSourceRegistrar
     (
         "test_asset_path", 
@@ -152,4 +356,588 @@ TEST(Asset, Create)
 
     // Release the asset
     asset.reset();
+}
+
+TEST(Asset, Handle)
+{
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetUnloader unloader;
+
+    riaecs::ID assetID = assetContainer.Add(std::make_unique<TestAsset>());
+    {
+        riaecs::AssetHandle<TestAsset> handle(assetID, referenceTable);
+        riaecs::AssetHandle<TestAsset> copiedHandle = handle;
+        EXPECT_EQ(referenceTable.GetRefCount(assetID), 2);
+
+        // Verify the asset through the typed handle
+        EXPECT_EQ(handle.Get(assetContainer)().value, INITIAL_ASSET_VALUE);
+
+        riaecs::AssetHandle<TestAsset> movedHandle = std::move(copiedHandle);
+        EXPECT_FALSE(copiedHandle.IsValid());
+        EXPECT_EQ(referenceTable.GetRefCount(assetID), 2);
+    }
+    EXPECT_EQ(referenceTable.GetRefCount(assetID), 0);
+
+    // The asset stays loaded until the next frame boundary
+    EXPECT_TRUE(assetContainer.Contains(assetID));
+
+    // Re-acquire before the frame boundary, the asset must survive the unload
+    {
+        EXPECT_TRUE(referenceTable.TryAddRef(assetID));
+        EXPECT_EQ(unloader.Unload(assetContainer, referenceTable), 0);
+        EXPECT_TRUE(assetContainer.Contains(assetID));
+        referenceTable.Release(assetID);
+    }
+
+    EXPECT_EQ(unloader.Unload(assetContainer, referenceTable), 1);
+    unloader.WaitIdle();
+    EXPECT_FALSE(assetContainer.Contains(assetID));
+    EXPECT_FALSE(referenceTable.TryAddRef(assetID));
+
+    // The stale ID must not alias a new asset stored in the same slot
+    riaecs::ID newAssetID = assetContainer.Add(std::make_unique<TestAsset>());
+    EXPECT_EQ(newAssetID.GetIndex(), assetID.GetIndex());
+    EXPECT_FALSE(assetContainer.Contains(assetID));
+}
+
+TEST(Asset, Deduplicate)
+{
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<CountingFileLoader>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<TestAssetFactory>());
+
+    // The same path, loader and factory must resolve to the same source
+    size_t sourceID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("dedup_path", loaderID, factoryID));
+    EXPECT_EQ(sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("dedup_path", loaderID, factoryID)), sourceID);
+    EXPECT_EQ(sourceRegistry.GetCount(), 1);
+    EXPECT_EQ(sourceRegistry.Find("dedup_path", loaderID, factoryID), sourceID);
+    EXPECT_EQ(sourceRegistry.Find("dedup_path"), sourceID);
+    EXPECT_FALSE(sourceRegistry.Find("unknown_path").has_value());
+
+    // The decoder changes the bytes the factory sees, so it cannot be dropped silently
+    {
+        std::unique_ptr<riaecs::AssetSource> decoded 
+        = std::make_unique<riaecs::AssetSource>("dedup_path", loaderID, factoryID);
+        decoded->SetFileDecoderID(0);
+        EXPECT_THROW(sourceRegistry.Add(std::move(decoded)), std::runtime_error);
+        EXPECT_EQ(sourceRegistry.GetCount(), 1);
+    }
+
+    // So would a dependency of the second registration
+    size_t otherID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("other_path", loaderID, factoryID));
+    EXPECT_THROW
+    (
+        sourceRegistry.Add
+        (
+            std::make_unique<riaecs::AssetSource>("dedup_path", loaderID, factoryID, std::vector<size_t>{otherID})
+        ), 
+        std::runtime_error
+    );
+    EXPECT_TRUE(sourceRegistry.Get(sourceID)().GetDependencies().empty());
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetUnloader unloader;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    const CountingFileLoader &countingLoader 
+    = dynamic_cast<const CountingFileLoader&>(fileLoaderRegistry.Get(loaderID)());
+
+    // Concurrent requests must join the in-flight load
+    {
+        riaecs::AssetHandle<TestAsset> handleA;
+        riaecs::AssetHandle<TestAsset> handleB;
+        std::thread threadA([&]() { handleA = assetLoader.Load<TestAsset>(sourceID); });
+        std::thread threadB([&]() { handleB = assetLoader.Load<TestAsset>("dedup_path"); });
+        threadA.join();
+        threadB.join();
+
+        EXPECT_EQ(countingLoader.loadCount, 1);
+        EXPECT_EQ(handleA.GetID(), handleB.GetID());
+        EXPECT_EQ(referenceTable.GetRefCount(handleA.GetID()), 2);
+
+        // Repeat requests return the live asset
+        riaecs::AssetHandle<TestAsset> handleC = assetLoader.Load<TestAsset>(sourceID);
+        EXPECT_EQ(handleC.GetID(), handleA.GetID());
+        EXPECT_EQ(countingLoader.loadCount, 1);
+
+        riaecs::ID loadedID;
+        EXPECT_TRUE(assetLoader.FindLoaded(sourceID, loadedID));
+        EXPECT_EQ(loadedID, handleA.GetID());
+    }
+
+    // Once unloaded, the next request loads the file again
+    unloader.Unload(assetContainer, referenceTable);
+    unloader.WaitIdle();
+
+    riaecs::ID loadedID;
+    EXPECT_FALSE(assetLoader.FindLoaded(sourceID, loadedID));
+
+    riaecs::AssetHandle<TestAsset> reloadedHandle = assetLoader.Load<TestAsset>(sourceID);
+    EXPECT_EQ(countingLoader.loadCount, 2);
+}
+
+TEST(Asset, LoadGraph)
+{
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<PathFileLoader>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<RecordingAssetFactory>());
+
+    size_t textureID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("texture", loaderID, factoryID));
+    size_t shaderID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("shader", loaderID, factoryID));
+    size_t materialID = sourceRegistry.Add
+    (
+        std::make_unique<riaecs::AssetSource>("material", loaderID, factoryID, std::vector<size_t>{textureID, shaderID})
+    );
+    size_t modelID = sourceRegistry.Add
+    (
+        std::make_unique<riaecs::AssetSource>("model", loaderID, factoryID, std::vector<size_t>{materialID, textureID})
+    );
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+    riaecs::ThreadPool workers(4);
+
+    std::vector<riaecs::AssetHandle<riaecs::IAsset>> handles = assetLoader.LoadGraph({modelID}, workers);
+    EXPECT_EQ(handles.size(), 4);
+
+    // Every asset must be created after its dependencies
+    const RecordingAssetFactory &factory 
+    = dynamic_cast<const RecordingAssetFactory&>(assetFactoryRegistry.Get(factoryID)());
+    {
+        std::lock_guard<std::mutex> lock(factory.mutex);
+        const std::vector<std::string> &paths = factory.createdPaths;
+        ASSERT_EQ(paths.size(), 4);
+
+        auto indexOf = [&paths](const std::string &path)
+        {
+            return std::find(paths.begin(), paths.end(), path) - paths.begin();
+        };
+        EXPECT_LT(indexOf("texture"), indexOf("material"));
+        EXPECT_LT(indexOf("shader"), indexOf("material"));
+        EXPECT_LT(indexOf("material"), indexOf("model"));
+    }
+
+    // Assets already loaded are shared with the next graph
+    std::vector<riaecs::AssetHandle<riaecs::IAsset>> materialHandles = assetLoader.LoadGraph({materialID}, workers);
+    EXPECT_EQ(materialHandles.size(), 3);
+    {
+        std::lock_guard<std::mutex> lock(factory.mutex);
+        EXPECT_EQ(factory.createdPaths.size(), 4);
+    }
+
+    // Circular dependencies must be reported
+    size_t cycleAID = sourceRegistry.Add
+    (
+        std::make_unique<riaecs::AssetSource>("cycle_a", loaderID, factoryID, std::vector<size_t>{modelID + 2})
+    );
+    sourceRegistry.Add
+    (
+        std::make_unique<riaecs::AssetSource>("cycle_b", loaderID, factoryID, std::vector<size_t>{cycleAID})
+    );
+    EXPECT_THROW(assetLoader.LoadGraph({cycleAID}, workers), std::runtime_error);
+}
+
+TEST(Asset, LoadQueue)
+{
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t gatedLoaderID = fileLoaderRegistry.Add(std::make_unique<GatedFileLoader>());
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<PathFileLoader>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<RecordingAssetFactory>());
+
+    size_t blockerID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("blocker", gatedLoaderID, factoryID));
+    size_t lowID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("low", loaderID, factoryID));
+    size_t middleID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("middle", loaderID, factoryID));
+    size_t highID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("high", loaderID, factoryID));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    // A single worker makes the start order observable
+    riaecs::ThreadPool workers(1);
+    riaecs::AssetLoadQueue loadQueue(assetLoader, workers);
+
+    const GatedFileLoader &gatedLoader = dynamic_cast<const GatedFileLoader&>(fileLoaderRegistry.Get(gatedLoaderID)());
+    const RecordingAssetFactory &factory 
+    = dynamic_cast<const RecordingAssetFactory&>(assetFactoryRegistry.Get(factoryID)());
+
+    std::shared_ptr<riaecs::AssetLoadRequest> blockerRequest = loadQueue.Enqueue(blockerID, 0);
+    while (blockerRequest->GetStatus() != riaecs::AssetLoadStatus::Loading)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    std::shared_ptr<riaecs::AssetLoadRequest> lowRequest = loadQueue.Enqueue(lowID, 1);
+    std::shared_ptr<riaecs::AssetLoadRequest> middleRequest = loadQueue.Enqueue(middleID, 2);
+    std::shared_ptr<riaecs::AssetLoadRequest> highRequest = loadQueue.Enqueue(highID, 3);
+    EXPECT_EQ(loadQueue.GetQueuedCount(), 3);
+
+    // Raise the priority of the low request and cancel the middle request before they start
+    loadQueue.SetPriority(lowRequest, 10);
+    EXPECT_EQ(lowRequest->GetPriority(), 10);
+    loadQueue.Cancel(middleRequest);
+    EXPECT_EQ(middleRequest->GetStatus(), riaecs::AssetLoadStatus::Cancelled);
+    EXPECT_EQ(loadQueue.GetQueuedCount(), 2);
+
+    gatedLoader.isOpen = true;
+    EXPECT_EQ(blockerRequest->Wait(), riaecs::AssetLoadStatus::Loaded);
+    EXPECT_EQ(lowRequest->Wait(), riaecs::AssetLoadStatus::Loaded);
+    EXPECT_EQ(highRequest->Wait(), riaecs::AssetLoadStatus::Loaded);
+    EXPECT_EQ(middleRequest->Wait(), riaecs::AssetLoadStatus::Cancelled);
+
+    {
+        std::lock_guard<std::mutex> lock(factory.mutex);
+        EXPECT_EQ(factory.createdPaths, (std::vector<std::string>{"blocker", "low", "high"}));
+    }
+
+    riaecs::AssetHandle<TestAsset> lowHandle = lowRequest->GetHandle<TestAsset>();
+    EXPECT_EQ(lowHandle.Get(assetContainer)().value, INITIAL_ASSET_VALUE);
+
+    // Cancel a load which has already started, it stops before the factory stages
+    gatedLoader.isOpen = false;
+    size_t partialID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>("partial", gatedLoaderID, factoryID));
+    std::shared_ptr<riaecs::AssetLoadRequest> partialRequest = loadQueue.Enqueue(partialID, 0);
+    while (partialRequest->GetStatus() != riaecs::AssetLoadStatus::Loading)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    loadQueue.Cancel(partialRequest);
+    gatedLoader.isOpen = true;
+    EXPECT_EQ(partialRequest->Wait(), riaecs::AssetLoadStatus::Cancelled);
+
+    riaecs::ID partialAssetID;
+    EXPECT_FALSE(assetLoader.FindLoaded(partialID, partialAssetID));
+    {
+        std::lock_guard<std::mutex> lock(factory.mutex);
+        EXPECT_EQ(factory.createdPaths.size(), 3);
+    }
+}
+
+TEST(Asset, Stream)
+{
+    const size_t FILE_SIZE = 5000;
+    std::filesystem::path filePath = std::filesystem::temp_directory_path() / "riaecs_asset_stream_test.bin";
+    size_t expectedSum = 0;
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        for (size_t i = 0; i < FILE_SIZE; ++i)
+        {
+            file.put(static_cast<char>(i % 100));
+            expectedSum += i % 100;
+        }
+    }
+
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<riaecs::BinaryFileLoader>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<ByteSumAssetFactory>());
+    size_t sourceID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>(filePath.string(), loaderID, factoryID));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    // The streaming factory never sees more than one chunk at a time
+    {
+        riaecs::AssetHandle<ByteSumAsset> handle = assetLoader.Load<ByteSumAsset>(sourceID);
+        EXPECT_EQ(handle.Get(assetContainer)().sum, expectedSum);
+        EXPECT_EQ(handle.Get(assetContainer)().maxChunkSize, ByteSumAssetFactory::CHUNK_SIZE);
+    }
+
+    std::filesystem::remove(filePath);
+}
+
+TEST(Asset, HotReload)
+{
+    std::filesystem::path filePath = std::filesystem::temp_directory_path() / "riaecs_asset_hot_reload_test.bin";
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        file.put(static_cast<char>(1));
+    }
+
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<riaecs::BinaryFileLoader>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<ByteSumAssetFactory>());
+    size_t sourceID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>(filePath.string(), loaderID, factoryID));
+
+    // The same file spelled differently, which must be reloaded as well
+    size_t otherFactoryID = assetFactoryRegistry.Add(std::make_unique<ByteSumAssetFactory>());
+    std::filesystem::path otherPath = filePath.parent_path() / "." / filePath.filename();
+    size_t otherSourceID 
+    = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>(otherPath.string(), loaderID, otherFactoryID));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    riaecs::ThreadPool workers(2);
+    riaecs::AssetWatcher assetWatcher(assetLoader, sourceRegistry, workers);
+    assetWatcher.WatchAll();
+
+    riaecs::AssetHandle<ByteSumAsset> handle = assetLoader.Load<ByteSumAsset>(sourceID);
+    EXPECT_EQ(handle.Get(assetContainer)().sum, 1);
+    riaecs::AssetHandle<ByteSumAsset> otherHandle = assetLoader.Load<ByteSumAsset>(otherSourceID);
+
+    // Nothing changed yet
+    EXPECT_EQ(assetWatcher.Update(), 0);
+
+    // Polling watchers compare write times, make sure the new one differs
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        file.put(static_cast<char>(2));
+        file.put(static_cast<char>(3));
+    }
+    std::filesystem::last_write_time(filePath, std::filesystem::file_time_type::clock::now());
+
+    size_t swappedCount = 0;
+    for (int i = 0; i < 500 && swappedCount < 2; ++i)
+    {
+        swappedCount += assetWatcher.Update();
+        assetWatcher.WaitIdle();
+        if (swappedCount < 2)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // The same handle sees the new asset
+    EXPECT_EQ(swappedCount, 2);
+    EXPECT_EQ(handle.Get(assetContainer)().sum, 5);
+    EXPECT_EQ(otherHandle.Get(assetContainer)().sum, 5);
+    EXPECT_TRUE(referenceTable.GetRefCount(handle.GetID()) == 1);
+
+    std::filesystem::remove(filePath);
+}
+
+TEST(Asset, Decode)
+{
+    const size_t FILE_SIZE = 20000;
+    std::filesystem::path rawPath = std::filesystem::temp_directory_path() / "riaecs_asset_decode_test.bin";
+    std::filesystem::path compressedPath = std::filesystem::temp_directory_path() / "riaecs_asset_decode_test.rlz";
+    size_t expectedSum = 0;
+    {
+        std::ofstream file(rawPath, std::ios::binary);
+        for (size_t i = 0; i < FILE_SIZE; ++i)
+        {
+            file.put(static_cast<char>(i % 50));
+            expectedSum += i % 50;
+        }
+    }
+    riaecs::LZCodec::CompressFile(rawPath.string(), compressedPath.string());
+    EXPECT_LT(std::filesystem::file_size(compressedPath), FILE_SIZE);
+
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::FileDecoderRegistry fileDecoderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<riaecs::BinaryFileLoader>());
+    size_t decoderID = fileDecoderRegistry.Add(std::make_unique<riaecs::LZFileDecoder>());
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<ByteSumAssetFactory>());
+
+    std::unique_ptr<riaecs::AssetSource> source 
+    = std::make_unique<riaecs::AssetSource>(compressedPath.string(), loaderID, factoryID);
+    source->SetFileDecoderID(decoderID);
+    size_t sourceID = sourceRegistry.Add(std::move(source));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, fileDecoderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    // The factory receives the decompressed bytes as a whole
+    {
+        riaecs::AssetHandle<ByteSumAsset> handle = assetLoader.Load<ByteSumAsset>(sourceID);
+        EXPECT_EQ(handle.Get(assetContainer)().sum, expectedSum);
+        EXPECT_EQ(handle.Get(assetContainer)().maxChunkSize, FILE_SIZE);
+    }
+
+    // The decoded buffer went back to the decoder pool
+    {
+        riaecs::ReadOnlyObject<riaecs::IFileDecoder> decoder = fileDecoderRegistry.Get(decoderID);
+        EXPECT_EQ(dynamic_cast<const riaecs::LZFileDecoder&>(decoder()).GetBufferPool().GetFreeCount(), 1);
+    }
+
+    std::filesystem::remove(rawPath);
+    std::filesystem::remove(compressedPath);
+}
+
+TEST(Asset, Memory)
+{
+    const size_t FILE_SIZE = 3000;
+    std::filesystem::path filePath = std::filesystem::temp_directory_path() / "riaecs_asset_memory_test.bin";
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        for (size_t i = 0; i < FILE_SIZE; ++i)
+            file.put(static_cast<char>(i % 7));
+    }
+
+    riaecs::AssetMemory fileMemory
+    (
+        std::make_unique<mem_alloc_fixed_block::FixedBlockPoolFactory>(),
+        std::make_unique<mem_alloc_fixed_block::FixedBlockAllocatorFactory>()
+    );
+    riaecs::AssetMemory assetMemory
+    (
+        std::make_unique<mem_alloc_fixed_block::FixedBlockPoolFactory>(),
+        std::make_unique<mem_alloc_fixed_block::FixedBlockAllocatorFactory>()
+    );
+
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<riaecs::BinaryFileLoader>(fileMemory));
+    size_t factoryID = assetFactoryRegistry.Add(std::make_unique<MemoryBlockAssetFactory>());
+    size_t sourceID = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>(filePath.string(), loaderID, factoryID));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+    assetLoader.SetAssetMemory(factoryID, assetMemory);
+
+    {
+        riaecs::AssetHandle<MemoryBlockAsset> handle = assetLoader.Load<MemoryBlockAsset>(sourceID);
+        {
+            riaecs::ReadOnlyObject<MemoryBlockAsset> asset = handle.Get(assetContainer);
+            EXPECT_EQ(asset().block.GetSize(), FILE_SIZE);
+            EXPECT_EQ(asset().block.GetData()[FILE_SIZE - 1], static_cast<std::byte>((FILE_SIZE - 1) % 7));
+        }
+
+        // The file data was released after the load, the asset data stays in the factory memory
+        EXPECT_EQ(fileMemory.GetUsedSize(), 0);
+        EXPECT_GE(assetMemory.GetUsedSize(), FILE_SIZE);
+    }
+
+    // Unloading frees the asset data, then the pools are released in bulk
+    riaecs::AssetUnloader unloader;
+    EXPECT_EQ(unloader.Unload(assetContainer, referenceTable), 1);
+    unloader.WaitIdle();
+
+    EXPECT_EQ(assetMemory.GetUsedSize(), 0);
+    assetMemory.Reset();
+    EXPECT_EQ(assetMemory.GetPoolCount(), 0);
+
+    std::filesystem::remove(filePath);
+}
+
+TEST(Asset, Profile)
+{
+    const size_t FILE_SIZE = 4000;
+    std::filesystem::path rawPath = std::filesystem::temp_directory_path() / "riaecs_asset_profile_test.bin";
+    std::filesystem::path compressedPath = std::filesystem::temp_directory_path() / "riaecs_asset_profile_test.rlz";
+    std::filesystem::path tracePath = std::filesystem::temp_directory_path() / "riaecs_asset_profile_test.json";
+    {
+        std::ofstream file(rawPath, std::ios::binary);
+        for (size_t i = 0; i < FILE_SIZE; ++i)
+            file.put(static_cast<char>(i % 3));
+    }
+    riaecs::LZCodec::CompressFile(rawPath.string(), compressedPath.string());
+
+    riaecs::AssetSourceRegistry sourceRegistry;
+    riaecs::FileLoaderRegistry fileLoaderRegistry;
+    riaecs::FileDecoderRegistry fileDecoderRegistry;
+    riaecs::AssetFactoryRegistry assetFactoryRegistry;
+
+    size_t loaderID = fileLoaderRegistry.Add(std::make_unique<riaecs::BinaryFileLoader>());
+    size_t decoderID = fileDecoderRegistry.Add(std::make_unique<riaecs::LZFileDecoder>());
+    size_t streamFactoryID = assetFactoryRegistry.Add(std::make_unique<ByteSumAssetFactory>());
+    size_t stagedFactoryID = assetFactoryRegistry.Add(std::make_unique<StagedByteSumAssetFactory>());
+
+    size_t rawSourceID 
+    = sourceRegistry.Add(std::make_unique<riaecs::AssetSource>(rawPath.string(), loaderID, streamFactoryID));
+
+    std::unique_ptr<riaecs::AssetSource> compressedSource 
+    = std::make_unique<riaecs::AssetSource>(compressedPath.string(), loaderID, stagedFactoryID);
+    compressedSource->SetFileDecoderID(decoderID);
+    size_t compressedSourceID = sourceRegistry.Add(std::move(compressedSource));
+
+    riaecs::AssetContainer assetContainer;
+    riaecs::AssetReferenceTable referenceTable;
+    riaecs::AssetLoader assetLoader
+    (
+        sourceRegistry, fileLoaderRegistry, fileDecoderRegistry, assetFactoryRegistry, assetContainer, referenceTable
+    );
+
+    riaecs::AssetLoadProfiler profiler;
+    profiler.SetTraceEnabled(true);
+    assetLoader.SetProfiler(profiler);
+
+    {
+        riaecs::ThreadPool workers(1);
+        riaecs::AssetLoadQueue loadQueue(assetLoader, workers);
+
+        std::shared_ptr<riaecs::AssetLoadRequest> rawRequest = loadQueue.Enqueue(rawSourceID, 0);
+        std::shared_ptr<riaecs::AssetLoadRequest> compressedRequest = loadQueue.Enqueue(compressedSourceID, 0);
+        EXPECT_EQ(rawRequest->Wait(), riaecs::AssetLoadStatus::Loaded);
+        EXPECT_EQ(compressedRequest->Wait(), riaecs::AssetLoadStatus::Loaded);
+    }
+
+    // Streamed source reads the whole file without a decode stage
+    riaecs::AssetLoadStats rawStats = profiler.GetSourceStats(rawSourceID);
+    EXPECT_EQ(rawStats.loadCount, 1);
+    EXPECT_EQ(rawStats.bytesRead, FILE_SIZE);
+    EXPECT_EQ(rawStats.GetStageTime(riaecs::AssetLoadStage::Decode).count(), 0);
+    EXPECT_GT(rawStats.GetStageTime(riaecs::AssetLoadStage::Create).count(), 0);
+
+    // Compressed source reads fewer bytes and reports its staging size
+    riaecs::AssetLoadStats compressedStats = profiler.GetSourceStats(compressedSourceID);
+    EXPECT_EQ(compressedStats.loadCount, 1);
+    EXPECT_EQ(compressedStats.bytesRead, std::filesystem::file_size(compressedPath));
+    EXPECT_LT(compressedStats.bytesRead, FILE_SIZE);
+    EXPECT_GT(compressedStats.GetStageTime(riaecs::AssetLoadStage::Decode).count(), 0);
+    EXPECT_EQ(compressedStats.peakStagingSize, SizedStagingArea::SIZE);
+
+    // The second request waited behind the first on the single worker
+    EXPECT_GT(compressedStats.queueWaitTime.count(), 0);
+    EXPECT_EQ(profiler.GetFactoryStats(stagedFactoryID).loadCount, 1);
+
+    std::string report = profiler.CreateReport();
+    EXPECT_NE(report.find("[Factory " + std::to_string(streamFactoryID) + "]"), std::string::npos);
+    EXPECT_NE(report.find(compressedPath.string()), std::string::npos);
+
+    profiler.WriteTrace(tracePath.string());
+    {
+        std::ifstream file(tracePath);
+        std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(trace.find("{\"traceEvents\":["), 0);
+        EXPECT_NE(trace.find("\"name\":\"Decode\""), std::string::npos);
+    }
+
+    std::filesystem::remove(rawPath);
+    std::filesystem::remove(compressedPath);
+    std::filesystem::remove(tracePath);
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿#include "riaecs_unit_test/pch.h"
+
+#include "riaecs/include/compression.h"
+#pragma comment(lib, "riaecs.lib")
+
+#include <random>
+
+namespace
+{
+    std::vector<std::byte> RoundTrip(const std::vector<std::byte> &data)
+    {
+        std::vector<std::byte> compressed = riaecs::LZCodec::Compress(data.data(), data.size());
+
+        size_t size = riaecs::LZCodec::GetDecompressedSize(compressed.data(), compressed.size());
+        std::vector<std::byte> decompressed(size);
+        riaecs::LZCodec::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size());
+
+        return decompressed;
+    }
+
+} // namespace
+
+TEST(Compression, LZCodec)
+{
+    // Empty and tiny inputs
+    EXPECT_TRUE(RoundTrip({}).empty());
+    {
+        std::vector<std::byte> data = { std::byte{1}, std::byte{2}, std::byte{3} };
+        EXPECT_EQ(RoundTrip(data), data);
+    }
+
+    // Repetitive data compresses, including long overlapping matches
+    {
+        std::vector<std::byte> data;
+        for (size_t i = 0; i < 100000; ++i)
+            data.push_back(static_cast<std::byte>((i / 7) % 13));
+        for (size_t i = 0; i < 5000; ++i)
+            data.push_back(std::byte{42});
+
+        std::vector<std::byte> compressed = riaecs::LZCodec::Compress(data.data(), data.size());
+        EXPECT_LT(compressed.size(), data.size() / 10);
+        EXPECT_EQ(RoundTrip(data), data);
+    }
+
+    // Random data survives with little overhead
+    {
+        std::mt19937 random(1234);
+        std::vector<std::byte> data(70000);
+        for (std::byte &value : data)
+            value = static_cast<std::byte>(random() & 0xFF);
+
+        std::vector<std::byte> compressed = riaecs::LZCodec::Compress(data.data(), data.size());
+        EXPECT_LT(compressed.size(), data.size() + data.size() / 100 + riaecs::LZCodec::HEADER_SIZE);
+        EXPECT_EQ(RoundTrip(data), data);
+    }
+
+    // Corrupted data is rejected
+    {
+        std::vector<std::byte> data(1000, std::byte{7});
+        std::vector<std::byte> compressed = riaecs::LZCodec::Compress(data.data(), data.size());
+        compressed.pop_back();
+
+        std::vector<std::byte> decompressed(data.size());
+        EXPECT_THROW
+        (
+            riaecs::LZCodec::Decompress(compressed.data(), compressed.size(), decompressed.data(), decompressed.size()),
+            std::runtime_error
+        );
+
+        std::byte notCompressed[4] = {};
+        EXPECT_THROW(riaecs::LZCodec::GetDecompressedSize(notCompressed, sizeof(notCompressed)), std::runtime_error);
+    }
+}
+
+TEST(Compression, ByteBufferPool)
+{
+    riaecs::ByteBufferPool pool(2);
+
+    riaecs::ByteBuffer buffer = pool.Acquire(1024);
+    EXPECT_EQ(buffer.size(), 1024);
+    const std::byte *data = buffer.data();
+    buffer[0] = std::byte{0x5A};
+
+    // A smaller request reuses the released buffer without allocating
+    pool.Release(std::move(buffer));
+    EXPECT_EQ(pool.GetFreeCount(), 1);
+
+    riaecs::ByteBuffer reused = pool.Acquire(512);
+    EXPECT_EQ(reused.size(), 512);
+    EXPECT_EQ(reused.data(), data);
+    EXPECT_EQ(pool.GetFreeCount(), 0);
+
+    // Reused bytes are not cleared again
+    EXPECT_EQ(reused[0], std::byte{0x5A});
+
+    // Decoded file data returns its buffer to the pool
+    {
+        riaecs::MemoryFileData fileData(std::move(reused), pool);
+    }
+    EXPECT_EQ(pool.GetFreeCount(), 1);
+
+    // The pool keeps at most the max free buffer count
+    pool.Release(pool.Acquire(16));
+    pool.Release(riaecs::ByteBuffer(16));
+    pool.Release(riaecs::ByteBuffer(16));
+    EXPECT_EQ(pool.GetFreeCount(), 2);
+}
\ No newline at end of file
@@ -76,7 +76,7 @@ namespace
             size_t componentCount = 0;
             for (riaecs::Entity entity : world.View(TestAComponentID())())
             {
-                riaecs::ReadOnlyObject<TestAComponent*> test 
+                riaecs::ReadOnlyObject<const TestAComponent*> test 
                 = riaecs::GetComponent<TestAComponent>(world, entity, TestAComponentID());
 
                 //world.AddComponent(entity, TestBComponentID()); // Should deadlock
@@ -115,8 +115,190 @@ namespace
         }
     };
 
+    class TypedPositionComponent
+    {
+    public:
+        float x = 1.0f;
+        float y = 2.0f;
+    };
+
+    class TypedNameComponent
+    {
+    public:
+        std::string name = "typed";
+    };
+
+    struct TrivialVelocityComponent
+    {
+        float x;
+        float y;
+    };
+
+    class SpawnComponent
+    {
+    public:
+        int level = 0;
+        std::string name = "default";
+
+        SpawnComponent() = default;
+        SpawnComponent(int level, std::string name) : level(level), name(std::move(name)) {}
+    };
+
+    class ThrowingComponent
+    {
+    public:
+        explicit ThrowingComponent(int) { throw std::runtime_error("construct failed"); }
+    };
+
+    class EnemyTag {};
+
+    // Component IDs are per type for the whole process, so each world layout uses its own types
+    struct QueryPositionComponent { float x, y; };
+    struct QueryVelocityComponent { float x, y; };
+    class QueryEnemyTag {};
+
+    struct BatchPositionComponent { float x, y; };
+    class BatchTag {};
+
+    struct ProjectilePositionComponent { float x, y; };
+
+    class ProjectileNameComponent
+    {
+    public:
+        std::string name = "unnamed";
+    };
+
+    class ProjectileTag {};
+
+    struct TrackedPositionComponent { float x, y; };
+
+    struct ObservedComponent { int value; };
+
+    class CountingObserver : public riaecs::IComponentObserver
+    {
+    public:
+        size_t addBatchCount = 0;
+        size_t removeBatchCount = 0;
+        std::unordered_set<riaecs::Entity> members;
+
+        void OnAdd(riaecs::IECSWorld &world, size_t componentID, const std::vector<riaecs::Entity> &entities) override
+        {
+            ++addBatchCount;
+            for (const riaecs::Entity &entity : entities)
+            {
+                members.insert(entity);
+
+                // The world lock is not held here
+                EXPECT_TRUE(world.HasComponent(entity, componentID));
+            }
+        }
+
+        void OnRemove(riaecs::IECSWorld &, size_t, const std::vector<riaecs::Entity> &entities) override
+        {
+            ++removeBatchCount;
+            for (const riaecs::Entity &entity : entities)
+                members.erase(entity);
+        }
+    };
+
+    struct CompactValueComponent { int value; };
+
+    class CompactNameComponent
+    {
+    public:
+        std::string name;
+    };
+
+    struct SortDepthComponent { float depth; };
+    struct SortMaterialComponent { int material; };
+
+    struct GroupPositionComponent { float x; };
+    struct GroupVelocityComponent { float v; };
+
+    struct SplitBodyComponent
+    {
+        struct Hot
+        {
+            int intValue;
+            float floatValue;
+            double doubleValue;
+        };
+
+        struct Cold
+        {
+            std::string name;
+        };
+    };
+
+    struct SplitPlainComponent { int value; };
+
+    struct SharedConfigComponent
+    {
+        static constexpr bool IS_SHARED = true;
+
+        std::string name;
+        int level;
+
+        bool operator==(const SharedConfigComponent &other) const
+        {
+            return level == other.level && name == other.name;
+        }
+    };
+
+    int g_countedDestroyCount = 0;
+
+    class CountedComponent
+    {
+    public:
+        ~CountedComponent() { ++g_countedDestroyCount; }
+    };
+
+    // Registers the component type into local registries, so the world does not depend on the global ones
+    template <typename T>
+    void RegisterTypedComponent
+    (
+        riaecs::IComponentFactoryRegistry &factoryRegistry, riaecs::IComponentMaxCountRegistry &maxCountRegistry,
+        size_t maxCount
+    ){
+        riaecs::ComponentType<T>::SetID(factoryRegistry.Add(std::make_unique<riaecs::ComponentFactory<T>>()));
+        maxCountRegistry.Add(std::make_unique<size_t>(maxCount));
+    }
+
+    // Registers Ts with the same max count in fresh registries and creates the world over fixed block pools.
+    // The max count is unused when Ts is empty
+    template <typename... Ts>
+    void CreateTypedWorld(riaecs::ECSWorld &world, [[maybe_unused]] size_t maxCount)
+    {
+        std::unique_ptr<riaecs::ComponentFactoryRegistry> factoryRegistry 
+        = std::make_unique<riaecs::ComponentFactoryRegistry>();
+        std::unique_ptr<riaecs::ComponentMaxCountRegistry> maxCountRegistry 
+        = std::make_unique<riaecs::ComponentMaxCountRegistry>();
+
+        (RegisterTypedComponent<Ts>(*factoryRegistry, *maxCountRegistry, maxCount), ...);
+
+        world.SetComponentFactoryRegistry(std::move(factoryRegistry));
+        world.SetComponentMaxCountRegistry(std::move(maxCountRegistry));
+        world.SetPoolFactory(std::make_unique<mem_alloc_fixed_block::FixedBlockPoolFactory>());
+        world.SetAllocatorFactory(std::make_unique<mem_alloc_fixed_block::FixedBlockAllocatorFactory>());
+        EXPECT_TRUE(world.IsReady());
+        world.CreateWorld();
+    }
+
 } // namespace
 
+namespace std
+{
+    template <>
+    struct hash<SharedConfigComponent>
+    {
+        size_t operator()(const SharedConfigComponent &config) const
+        {
+            return hash<string>()(config.name) ^ hash<int>()(config.level);
+        }
+    };
+
+} // namespace std
+
 TEST(ECS, World)
 {
     // Create asset container
@@ -154,7 +336,7 @@ TEST(ECS, World)
 
     // Get component
     {
-        riaecs::ReadOnlyObject<TestAComponent*> test 
+        riaecs::ReadOnlyObject<const TestAComponent*> test 
         = riaecs::GetComponent<TestAComponent>(*ecsWorld, entity1, TestAComponentID());
 
         EXPECT_NE(test(), nullptr);
@@ -162,7 +344,7 @@ TEST(ECS, World)
 
         for (riaecs::Entity entity : ecsWorld->View(TestAComponentID())())
         {
-            riaecs::ReadOnlyObject<TestAComponent*> testFromView 
+            riaecs::ReadOnlyObject<const TestAComponent*> testFromView 
             = riaecs::GetComponent<TestAComponent>(*ecsWorld, entity, TestAComponentID());
 
             EXPECT_NE(testFromView(), nullptr);
@@ -183,7 +365,7 @@ TEST(ECS, World)
 
     // Get component
     {
-        riaecs::ReadOnlyObject<TestBComponent*> test 
+        riaecs::ReadOnlyObject<const TestBComponent*> test 
         = riaecs::GetComponent<TestBComponent>(*ecsWorld, entity2, TestBComponentID());
 
         EXPECT_NE(test(), nullptr);
@@ -194,7 +376,7 @@ TEST(ECS, World)
 
         for (riaecs::Entity entity : ecsWorld->View(TestBComponentID())())
         {
-            riaecs::ReadOnlyObject<TestBComponent*> testFromView 
+            riaecs::ReadOnlyObject<const TestBComponent*> testFromView 
             = riaecs::GetComponent<TestBComponent>(*ecsWorld, entity, TestBComponentID());
 
             EXPECT_NE(testFromView(), nullptr);
@@ -208,7 +390,7 @@ TEST(ECS, World)
     size_t componentCount = 0;
     for (riaecs::Entity entity : ecsWorld->View(TestAComponentID())())
     {
-        riaecs::ReadOnlyObject<TestAComponent*> testFromView 
+        riaecs::ReadOnlyObject<const TestAComponent*> testFromView 
         = riaecs::GetComponent<TestAComponent>(*ecsWorld, entity, TestAComponentID());
 
         EXPECT_NE(testFromView(), nullptr);
@@ -242,4 +424,893 @@ TEST(ECS, World)
     systemLoop->Run(*ecsWorld, *assetContainer);
 
     ecsWorld->DestroyWorld();
+}
+
+TEST(ECS, ComponentType)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<TypedPositionComponent, TypedNameComponent>(world, 4);
+
+    // IDs live in the DLL so other modules see the same ones. A type keeps its first ID
+    size_t positionID = riaecs::ComponentType<TypedPositionComponent>::GetID();
+    EXPECT_TRUE(riaecs::ComponentType<TypedPositionComponent>::IsRegistered());
+    EXPECT_EQ(riaecs::FindComponentTypeID(typeid(TypedPositionComponent)), positionID);
+    EXPECT_THROW(riaecs::ComponentType<TypedPositionComponent>::SetID(positionID + 1), std::runtime_error);
+    EXPECT_EQ(riaecs::ComponentType<TypedPositionComponent>::GetID(), positionID);
+
+    // Metadata describes the type without going through the factory
+    {
+        const riaecs::ComponentMeta &positionMeta 
+        = world.GetComponentMeta(riaecs::ComponentType<TypedPositionComponent>::GetID());
+        EXPECT_EQ(positionMeta.size, sizeof(TypedPositionComponent));
+        EXPECT_EQ(positionMeta.alignment, alignof(TypedPositionComponent));
+        EXPECT_TRUE(positionMeta.isTriviallyCopyable);
+        EXPECT_TRUE(positionMeta.isTriviallyDestructible);
+
+        const riaecs::ComponentMeta &nameMeta 
+        = world.GetComponentMeta(riaecs::ComponentType<TypedNameComponent>::GetID());
+        EXPECT_FALSE(nameMeta.isTriviallyCopyable);
+        EXPECT_FALSE(nameMeta.isTriviallyDestructible);
+        ASSERT_NE(nameMeta.move, nullptr);
+
+        // Move relocates the component into another block
+        alignas(TypedNameComponent) std::byte src[sizeof(TypedNameComponent)];
+        alignas(TypedNameComponent) std::byte dst[sizeof(TypedNameComponent)];
+        nameMeta.construct(src);
+        reinterpret_cast<TypedNameComponent*>(src)->name = "moved";
+        nameMeta.move(dst, src);
+        EXPECT_EQ(reinterpret_cast<TypedNameComponent*>(dst)->name, "moved");
+        nameMeta.destroy(dst);
+    }
+
+    // Typed APIs take no component ID
+    riaecs::Entity entity = world.CreateEntity();
+    riaecs::AddComponent<TypedPositionComponent>(world, entity);
+    riaecs::AddComponent<TypedNameComponent>(world, entity);
+    EXPECT_TRUE(riaecs::HasComponent<TypedPositionComponent>(world, entity));
+
+    {
+        riaecs::ReadOnlyObject<const TypedPositionComponent*> position 
+        = riaecs::GetComponent<TypedPositionComponent>(world, entity);
+        ASSERT_NE(position(), nullptr);
+        EXPECT_EQ(position()->y, 2.0f);
+    }
+
+    EXPECT_EQ(riaecs::View<TypedNameComponent>(world)().size(), 1);
+
+    riaecs::RemoveComponent<TypedNameComponent>(world, entity);
+    EXPECT_FALSE(riaecs::HasComponent<TypedNameComponent>(world, entity));
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, TrivialComponent)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<TrivialVelocityComponent, CountedComponent>(world, 8);
+
+    const riaecs::ComponentMeta &velocityMeta 
+    = world.GetComponentMeta(riaecs::ComponentType<TrivialVelocityComponent>::GetID());
+    EXPECT_TRUE(velocityMeta.isTriviallyDefaultConstructible);
+
+    // Trivial components are zeroed and copied without calling through the meta
+    {
+        TrivialVelocityComponent src{3.0f, 4.0f};
+        TrivialVelocityComponent dst{};
+        velocityMeta.Copy(reinterpret_cast<std::byte*>(&dst), reinterpret_cast<const std::byte*>(&src));
+        EXPECT_EQ(dst.x, 3.0f);
+        EXPECT_EQ(dst.y, 4.0f);
+
+        velocityMeta.Construct(reinterpret_cast<std::byte*>(&dst));
+        EXPECT_EQ(dst.x, 0.0f);
+        EXPECT_EQ(dst.y, 0.0f);
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        riaecs::Entity entity = world.CreateEntity();
+        riaecs::AddComponent<TrivialVelocityComponent>(world, entity);
+        riaecs::AddComponent<CountedComponent>(world, entity);
+
+        riaecs::ReadOnlyObject<const TrivialVelocityComponent*> velocity 
+        = riaecs::GetComponent<TrivialVelocityComponent>(world, entity);
+        EXPECT_EQ(velocity()->x, 0.0f);
+        EXPECT_EQ(velocity()->y, 0.0f);
+    }
+
+    // Teardown still runs destructors of the components which have one
+    g_countedDestroyCount = 0;
+    world.DestroyWorld();
+    EXPECT_EQ(g_countedDestroyCount, 4);
+}
+
+TEST(ECS, EmplaceComponent)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<SpawnComponent, ThrowingComponent>(world, 2);
+
+    riaecs::Entity emplaced = world.CreateEntity();
+    riaecs::EmplaceComponent<SpawnComponent>(world, emplaced, 5, "boss");
+    {
+        riaecs::ReadOnlyObject<const SpawnComponent*> spawn = riaecs::GetComponent<SpawnComponent>(world, emplaced);
+        EXPECT_EQ(spawn()->level, 5);
+        EXPECT_EQ(spawn()->name, "boss");
+    }
+
+    riaecs::Entity moved = world.CreateEntity();
+    SpawnComponent source(3, "minion");
+    riaecs::AddComponent(world, moved, std::move(source));
+    {
+        riaecs::ReadOnlyObject<const SpawnComponent*> spawn = riaecs::GetComponent<SpawnComponent>(world, moved);
+        EXPECT_EQ(spawn()->level, 3);
+        EXPECT_EQ(spawn()->name, "minion");
+    }
+
+    // A throwing constructor leaves the entity without the component and the block free
+    riaecs::Entity failed = world.CreateEntity();
+    EXPECT_THROW(riaecs::EmplaceComponent<ThrowingComponent>(world, failed, 1), std::runtime_error);
+    EXPECT_FALSE(riaecs::HasComponent<ThrowingComponent>(world, failed));
+    EXPECT_THROW(riaecs::EmplaceComponent<ThrowingComponent>(world, failed, 1), std::runtime_error);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, TagComponent)
+{
+    // The max count does not limit tags because they take no pool blocks
+    riaecs::ECSWorld world;
+    CreateTypedWorld<EnemyTag>(world, 1);
+
+    EXPECT_TRUE(world.GetComponentMeta(riaecs::ComponentType<EnemyTag>::GetID()).isTag);
+
+    std::vector<riaecs::Entity> entities;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        entities.push_back(world.CreateEntity());
+        riaecs::AddComponent<EnemyTag>(world, entities.back());
+    }
+
+    EXPECT_TRUE(riaecs::HasComponent<EnemyTag>(world, entities[0]));
+    EXPECT_EQ(riaecs::View<EnemyTag>(world)().size(), 3);
+    EXPECT_EQ(riaecs::GetComponent<EnemyTag>(world, entities[0])(), nullptr);
+
+    riaecs::RemoveComponent<EnemyTag>(world, entities[0]);
+    EXPECT_FALSE(riaecs::HasComponent<EnemyTag>(world, entities[0]));
+
+    world.DestroyEntity(entities[1]);
+    EXPECT_EQ(riaecs::View<EnemyTag>(world)().size(), 1);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, Query)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<QueryPositionComponent, QueryVelocityComponent, QueryEnemyTag>(world, 8);
+
+    riaecs::Entity moving = world.CreateEntity();
+    riaecs::AddComponent<QueryPositionComponent>(world, moving);
+    riaecs::AddComponent<QueryVelocityComponent>(world, moving);
+
+    riaecs::Entity movingEnemy = world.CreateEntity();
+    riaecs::AddComponent<QueryPositionComponent>(world, movingEnemy);
+    riaecs::AddComponent<QueryVelocityComponent>(world, movingEnemy);
+    riaecs::AddComponent<QueryEnemyTag>(world, movingEnemy);
+
+    riaecs::Entity still = world.CreateEntity();
+    riaecs::AddComponent<QueryPositionComponent>(world, still);
+
+    EXPECT_EQ((riaecs::Query<QueryPositionComponent, QueryVelocityComponent>(world).size()), 2);
+    EXPECT_EQ(riaecs::Query<QueryPositionComponent>(world).size(), 3);
+
+    std::vector<riaecs::Entity> notEnemies = world.Query
+    (
+        {riaecs::ComponentType<QueryVelocityComponent>::GetID()}, 
+        {riaecs::ComponentType<QueryEnemyTag>::GetID()}
+    );
+    ASSERT_EQ(notEnemies.size(), 1);
+    EXPECT_EQ(notEnemies[0], moving);
+
+    // Destroying clears the signature, so a reused index starts empty
+    world.DestroyEntity(movingEnemy);
+    riaecs::Entity reused = world.CreateEntity();
+    EXPECT_EQ(reused.GetIndex(), movingEnemy.GetIndex());
+    EXPECT_FALSE(riaecs::HasComponent<QueryEnemyTag>(world, reused));
+    EXPECT_EQ((riaecs::Query<QueryPositionComponent, QueryVelocityComponent>(world).size()), 1);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, EntityHandle)
+{
+    riaecs::Entity entity(12345, 7);
+    EXPECT_EQ(sizeof(entity), sizeof(uint64_t));
+    EXPECT_EQ(entity.GetIndex(), 12345);
+    EXPECT_EQ(entity.GetGeneration(), 7);
+    EXPECT_NE(entity, riaecs::Entity(12345, 8));
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld(world, 0);
+
+    riaecs::Entity first = world.CreateEntity();
+    riaecs::Entity second = world.CreateEntity();
+    riaecs::Entity third = world.CreateEntity();
+
+    // Freed slots are reused last in, first out with the next generation
+    world.DestroyEntity(first);
+    world.DestroyEntity(third);
+    world.DestroyEntity(third); // Destroying twice is ignored
+
+    riaecs::Entity reusedThird = world.CreateEntity();
+    EXPECT_EQ(reusedThird.GetIndex(), third.GetIndex());
+    EXPECT_EQ(reusedThird.GetGeneration(), third.GetGeneration() + 1);
+
+    riaecs::Entity reusedFirst = world.CreateEntity();
+    EXPECT_EQ(reusedFirst.GetIndex(), first.GetIndex());
+
+    riaecs::Entity fresh = world.CreateEntity();
+    EXPECT_EQ(fresh.GetIndex(), 3);
+
+    // Stale handles are rejected
+    EXPECT_THROW(world.HasComponent(third, 0), std::runtime_error);
+    EXPECT_THROW(world.DestroyEntity(first), std::runtime_error);
+    EXPECT_NO_THROW(world.DestroyEntity(second));
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, BatchEntities)
+{
+    constexpr size_t BATCH_COUNT = 100;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<BatchPositionComponent, BatchTag>(world, BATCH_COUNT);
+
+    const std::vector<size_t> componentIDs 
+    = {riaecs::ComponentType<BatchPositionComponent>::GetID(), riaecs::ComponentType<BatchTag>::GetID()};
+
+    std::vector<riaecs::Entity> entities;
+    world.CreateEntities(BATCH_COUNT, componentIDs, entities);
+    ASSERT_EQ(entities.size(), BATCH_COUNT);
+    EXPECT_EQ((riaecs::Query<BatchPositionComponent, BatchTag>(world).size()), BATCH_COUNT);
+    EXPECT_EQ(riaecs::GetComponent<BatchPositionComponent>(world, entities.back())()->x, 0.0f);
+
+    // The pool is full, so freeing the batch must give every block back
+    std::vector<riaecs::Entity> firstHalf(entities.begin(), entities.begin() + BATCH_COUNT / 2);
+    world.DestroyEntities(firstHalf);
+    EXPECT_EQ(riaecs::View<BatchPositionComponent>(world)().size(), BATCH_COUNT / 2);
+
+    std::vector<riaecs::Entity> refilled;
+    world.CreateEntities(BATCH_COUNT / 2, componentIDs, refilled);
+    EXPECT_EQ(riaecs::View<BatchPositionComponent>(world)().size(), BATCH_COUNT);
+
+    // Clearing resets the pools in one go and keeps the world usable
+    world.Clear();
+    EXPECT_EQ(riaecs::View<BatchPositionComponent>(world)().size(), 0);
+    EXPECT_THROW(riaecs::HasComponent<BatchTag>(world, entities.back()), std::runtime_error);
+
+    std::vector<riaecs::Entity> afterClear;
+    world.CreateEntities(BATCH_COUNT, componentIDs, afterClear);
+    EXPECT_EQ(afterClear.front().GetIndex(), 0);
+    EXPECT_NE(afterClear.back(), entities.back());
+    EXPECT_EQ(riaecs::View<BatchPositionComponent>(world)().size(), BATCH_COUNT);
+
+    // A stale entity anywhere in the span is found before anything is destroyed
+    EXPECT_THROW(world.DestroyEntities({afterClear.front(), entities.back()}), std::runtime_error);
+    EXPECT_TRUE(riaecs::HasComponent<BatchPositionComponent>(world, afterClear.front()));
+
+    // A failing batch leaves no half built entity behind. Duplicates are rejected up front
+    std::vector<riaecs::Entity> failed;
+    const size_t positionID = riaecs::ComponentType<BatchPositionComponent>::GetID();
+    EXPECT_THROW(world.CreateEntities(1, {positionID, positionID}, failed), std::runtime_error);
+    EXPECT_TRUE(failed.empty());
+
+    // With one free block the second entity runs out after taking its tag
+    world.DestroyEntity(afterClear.back());
+    EXPECT_THROW
+    (
+        world.CreateEntities(2, {riaecs::ComponentType<BatchTag>::GetID(), positionID}, failed), std::runtime_error
+    );
+    EXPECT_EQ(failed.size(), 1);
+    EXPECT_EQ(riaecs::View<BatchTag>(world)().size(), BATCH_COUNT);
+    EXPECT_EQ(riaecs::View<BatchPositionComponent>(world)().size(), BATCH_COUNT);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, Prefab)
+{
+    constexpr size_t INSTANCE_COUNT = 16;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<ProjectilePositionComponent, ProjectileNameComponent, ProjectileTag>(world, INSTANCE_COUNT + 1);
+
+    // Build the template entity, capture it and throw it away
+    riaecs::Prefab prefab;
+    {
+        riaecs::Entity templateEntity = world.CreateEntity();
+        riaecs::EmplaceComponent<ProjectilePositionComponent>(world, templateEntity, 1.5f, -2.0f);
+        riaecs::EmplaceComponent<ProjectileNameComponent>(world, templateEntity, ProjectileNameComponent{"arrow"});
+        riaecs::AddComponent<ProjectileTag>(world, templateEntity);
+
+        prefab = world.CreatePrefab(templateEntity);
+        world.DestroyEntity(templateEntity);
+    }
+    EXPECT_EQ(prefab.GetComponentCount(), 3);
+
+    std::vector<riaecs::Entity> instances;
+    world.Instantiate(prefab, INSTANCE_COUNT, instances);
+    ASSERT_EQ(instances.size(), INSTANCE_COUNT);
+    EXPECT_EQ((riaecs::Query<ProjectilePositionComponent, ProjectileNameComponent, ProjectileTag>(world).size()), 
+        INSTANCE_COUNT);
+
+    for (const riaecs::Entity &instance : instances)
+    {
+        riaecs::ReadOnlyObject<const ProjectilePositionComponent*> position 
+        = riaecs::GetComponent<ProjectilePositionComponent>(world, instance);
+        EXPECT_EQ(position()->x, 1.5f);
+        EXPECT_EQ(position()->y, -2.0f);
+    }
+
+    // Instances own their copies
+    riaecs::GetMutableComponent<ProjectileNameComponent>(world, instances[0])()->name = "changed";
+    EXPECT_EQ(riaecs::GetComponent<ProjectileNameComponent>(world, instances[1])()->name, "arrow");
+
+    // A value captured as another type is rejected before anything is created
+    {
+        riaecs::Prefab mismatched;
+        const ProjectileNameComponent name{"wrong"};
+        mismatched.Add
+        (
+            riaecs::ComponentType<ProjectilePositionComponent>::GetID(), riaecs::ComponentType<ProjectileNameComponent>::META, 
+            reinterpret_cast<const std::byte*>(&name)
+        );
+
+        std::vector<riaecs::Entity> rejected;
+        EXPECT_THROW(world.Instantiate(mismatched, 1, rejected), std::runtime_error);
+        EXPECT_TRUE(rejected.empty());
+    }
+
+    // Running out of blocks part way keeps the finished instances and drops the half built one
+    {
+        riaecs::Prefab tagged;
+        const ProjectilePositionComponent position{0.0f, 0.0f};
+        tagged.Add(riaecs::ComponentType<ProjectileTag>::GetID(), riaecs::ComponentType<ProjectileTag>::META, nullptr);
+        tagged.Add
+        (
+            riaecs::ComponentType<ProjectilePositionComponent>::GetID(), riaecs::ComponentType<ProjectilePositionComponent>::META, 
+            reinterpret_cast<const std::byte*>(&position)
+        );
+
+        // One block is left, so the second instance fails after taking its tag
+        std::vector<riaecs::Entity> partial;
+        EXPECT_THROW(world.Instantiate(tagged, 2, partial), std::runtime_error);
+        EXPECT_EQ(partial.size(), 1);
+        EXPECT_EQ(riaecs::View<ProjectileTag>(world)().size(), INSTANCE_COUNT + 1);
+    }
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, ChangeTicks)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<TrackedPositionComponent>(world, 8);
+
+    std::vector<riaecs::Entity> entities;
+    world.CreateEntities(4, {riaecs::ComponentType<TrackedPositionComponent>::GetID()}, entities);
+
+    // Everything was added after tick 0
+    EXPECT_EQ(riaecs::Added<TrackedPositionComponent>(world, 0).size(), 4);
+
+    // A system ran at this tick and saw everything
+    uint64_t lastRunTick = world.AdvanceTick();
+    EXPECT_TRUE(riaecs::Changed<TrackedPositionComponent>(world, lastRunTick).empty());
+
+    world.AdvanceTick();
+    riaecs::GetMutableComponent<TrackedPositionComponent>(world, entities[2])()->x = 5.0f;
+
+    // Reading does not mark the component
+    EXPECT_EQ(riaecs::GetComponent<TrackedPositionComponent>(world, entities[1])()->x, 0.0f);
+    EXPECT_EQ
+    (
+        riaecs::GetComponent<TrackedPositionComponent>
+        (
+            world, entities[1], riaecs::ComponentType<TrackedPositionComponent>::GetID()
+        )()->x, 
+        0.0f
+    );
+
+    std::vector<riaecs::Entity> changed = riaecs::Changed<TrackedPositionComponent>(world, lastRunTick);
+    ASSERT_EQ(changed.size(), 1);
+    EXPECT_EQ(changed[0], entities[2]);
+
+    // The accessor taking an ID marks it as well
+    riaecs::GetMutableComponent<TrackedPositionComponent>
+    (
+        world, entities[3], riaecs::ComponentType<TrackedPositionComponent>::GetID()
+    )()->x = 5.0f;
+    EXPECT_EQ(riaecs::Changed<TrackedPositionComponent>(world, lastRunTick).size(), 2);
+    EXPECT_TRUE(riaecs::Added<TrackedPositionComponent>(world, lastRunTick).empty());
+
+    riaecs::Entity late = world.CreateEntity();
+    riaecs::AddComponent<TrackedPositionComponent>(world, late);
+    EXPECT_EQ(riaecs::Added<TrackedPositionComponent>(world, lastRunTick).size(), 1);
+    EXPECT_EQ(riaecs::Changed<TrackedPositionComponent>(world, lastRunTick).size(), 3);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, Observer)
+{
+    riaecs::ECSWorld world;
+    CreateTypedWorld<ObservedComponent>(world, 16);
+
+    const size_t componentID = riaecs::ComponentType<ObservedComponent>::GetID();
+    CountingObserver observer;
+    world.AddComponentObserver(componentID, observer);
+
+    std::vector<riaecs::Entity> entities;
+    world.CreateEntities(8, {componentID}, entities);
+    riaecs::Entity single = world.CreateEntity();
+    riaecs::EmplaceComponent<ObservedComponent>(world, single, 3);
+
+    // Nothing is delivered until the flush, then everything arrives in one batch
+    EXPECT_EQ(observer.addBatchCount, 0);
+    world.FlushObservers();
+    EXPECT_EQ(observer.addBatchCount, 1);
+    EXPECT_EQ(observer.members.size(), 9);
+
+    world.DestroyEntities({entities[0], entities[1]});
+    riaecs::RemoveComponent<ObservedComponent>(world, single);
+    world.FlushObservers();
+    EXPECT_EQ(observer.removeBatchCount, 1);
+    EXPECT_EQ(observer.members.size(), 6);
+
+    // Removed and added again before the flush, the events arrive in that order and the entity stays a member
+    riaecs::RemoveComponent<ObservedComponent>(world, entities[2]);
+    riaecs::EmplaceComponent<ObservedComponent>(world, entities[2], 4);
+    world.FlushObservers();
+    EXPECT_EQ(observer.removeBatchCount, 2);
+    EXPECT_EQ(observer.members.count(entities[2]), 1);
+    EXPECT_EQ(observer.members.size(), 6);
+
+    world.Clear();
+    world.FlushObservers();
+    EXPECT_TRUE(observer.members.empty());
+
+    world.RemoveComponentObserver(componentID, observer);
+    world.CreateEntities(1, {componentID}, entities);
+    world.FlushObservers();
+    EXPECT_TRUE(observer.members.empty());
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, Compact)
+{
+    // Enough components that a zero budget stops part way through one storage
+    constexpr size_t ENTITY_COUNT = 256;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<CompactValueComponent, CompactNameComponent>(world, ENTITY_COUNT);
+
+    std::vector<riaecs::Entity> entities;
+    for (size_t i = 0; i < ENTITY_COUNT; ++i)
+        entities.push_back(world.CreateEntity());
+
+    // Churn: add in reverse, remove every third and add them back so blocks and dense order are scattered
+    for (size_t i = ENTITY_COUNT; i > 0; --i)
+    {
+        riaecs::EmplaceComponent<CompactValueComponent>(world, entities[i - 1], static_cast<int>(i - 1));
+        riaecs::EmplaceComponent<CompactNameComponent>(world, entities[i - 1], std::to_string(i - 1));
+    }
+
+    for (size_t i = 0; i < ENTITY_COUNT; i += 3)
+    {
+        riaecs::RemoveComponent<CompactValueComponent>(world, entities[i]);
+        riaecs::RemoveComponent<CompactNameComponent>(world, entities[i]);
+    }
+
+    for (size_t i = 0; i < ENTITY_COUNT; i += 3)
+    {
+        riaecs::EmplaceComponent<CompactValueComponent>(world, entities[i], static_cast<int>(i));
+        riaecs::EmplaceComponent<CompactNameComponent>(world, entities[i], std::to_string(i));
+    }
+
+    // The budgeted pass finishes eventually
+    while (!world.Compact(std::chrono::microseconds(0)))
+    {
+    }
+
+    {
+        riaecs::ReadOnlyObject<std::vector<riaecs::Entity>> view = riaecs::View<CompactValueComponent>(world);
+        ASSERT_EQ(view().size(), ENTITY_COUNT);
+
+        const std::byte *previous = nullptr;
+        for (size_t i = 0; i < ENTITY_COUNT; ++i)
+        {
+            const riaecs::Entity &entity = view()[i];
+            EXPECT_EQ(entity.GetIndex(), i);
+
+            // Components are laid out in iteration order
+            const std::byte *data = world.GetComponent(entity, riaecs::ComponentType<CompactValueComponent>::GetID())();
+            if (previous)
+            {
+                EXPECT_GT(data, previous);
+            }
+            previous = data;
+
+            EXPECT_EQ(reinterpret_cast<const CompactValueComponent*>(data)->value, static_cast<int>(i));
+            EXPECT_EQ(riaecs::GetComponent<CompactNameComponent>(world, entity)()->name, std::to_string(i));
+        }
+    }
+
+    world.Compact();
+    EXPECT_EQ(riaecs::GetComponent<CompactNameComponent>(world, entities[5])()->name, "5");
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, Sort)
+{
+    constexpr size_t ENTITY_COUNT = 8;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<SortDepthComponent, SortMaterialComponent>(world, ENTITY_COUNT);
+
+    const float depths[ENTITY_COUNT] = {5.0f, 1.0f, 7.0f, 3.0f, 0.0f, 6.0f, 2.0f, 4.0f};
+    for (size_t i = 0; i < ENTITY_COUNT; ++i)
+    {
+        riaecs::Entity entity = world.CreateEntity();
+        riaecs::EmplaceComponent<SortDepthComponent>(world, entity, depths[i]);
+
+        // Only every other entity has a material
+        if (i % 2 == 0)
+            riaecs::EmplaceComponent<SortMaterialComponent>(world, entity, static_cast<int>(i));
+    }
+
+    riaecs::SortComponentByKey<SortDepthComponent>(world, [](const SortDepthComponent &c) { return c.depth; });
+    riaecs::SortComponentLike<SortMaterialComponent, SortDepthComponent>(world);
+
+    {
+        riaecs::ReadOnlyObject<std::vector<riaecs::Entity>> view = riaecs::View<SortDepthComponent>(world);
+        const std::byte *previous = nullptr;
+        for (size_t i = 0; i < view().size(); ++i)
+        {
+            const std::byte *data = world.GetComponent(view()[i], riaecs::ComponentType<SortDepthComponent>::GetID())();
+            EXPECT_EQ(reinterpret_cast<const SortDepthComponent*>(data)->depth, static_cast<float>(i));
+
+            // Sequential memory in the sorted order
+            if (previous)
+            {
+                EXPECT_GT(data, previous);
+            }
+            previous = data;
+        }
+    }
+
+    // Sorting what is already in order moves nothing
+    {
+        riaecs::Entity first = riaecs::View<SortDepthComponent>(world)()[0];
+        const std::byte *before = world.GetComponent(first, riaecs::ComponentType<SortDepthComponent>::GetID())();
+
+        riaecs::SortComponentByKey<SortDepthComponent>(world, [](const SortDepthComponent &c) { return c.depth; });
+        riaecs::SortComponentLike<SortMaterialComponent, SortDepthComponent>(world);
+
+        EXPECT_EQ(riaecs::View<SortDepthComponent>(world)()[0], first);
+        EXPECT_EQ(world.GetComponent(first, riaecs::ComponentType<SortDepthComponent>::GetID())(), before);
+    }
+
+    {
+        // Materials follow the depth order: entities 4, 6, 0, 2 have depths 0, 2, 5, 7
+        riaecs::ReadOnlyObject<std::vector<riaecs::Entity>> view = riaecs::View<SortMaterialComponent>(world);
+        ASSERT_EQ(view().size(), ENTITY_COUNT / 2);
+
+        const int expectedMaterials[ENTITY_COUNT / 2] = {4, 6, 0, 2};
+        for (size_t i = 0; i < view().size(); ++i)
+        {
+            const std::byte *data = world.GetComponent(view()[i], riaecs::ComponentType<SortMaterialComponent>::GetID())();
+            EXPECT_EQ(reinterpret_cast<const SortMaterialComponent*>(data)->material, expectedMaterials[i]);
+        }
+    }
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, OwningGroup)
+{
+    constexpr size_t ENTITY_COUNT = 10;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<GroupPositionComponent, GroupVelocityComponent>(world, ENTITY_COUNT);
+
+    // Every entity moves, only the even ones have a velocity
+    std::vector<riaecs::Entity> entities;
+    for (size_t i = 0; i < ENTITY_COUNT; ++i)
+    {
+        riaecs::Entity entity = world.CreateEntity();
+        riaecs::EmplaceComponent<GroupPositionComponent>(world, entity, static_cast<float>(i));
+        if (i % 2 == 0)
+            riaecs::EmplaceComponent<GroupVelocityComponent>(world, entity, static_cast<float>(i) * 10.0f);
+        entities.push_back(entity);
+    }
+
+    // Existing members are pulled in when the group is created
+    size_t groupID = riaecs::CreateGroup<GroupPositionComponent, GroupVelocityComponent>(world);
+    EXPECT_EQ(world.GetGroup(groupID)().size, ENTITY_COUNT / 2);
+
+    // Entity 1 joins, 0 and 2 leave
+    riaecs::EmplaceComponent<GroupVelocityComponent>(world, entities[1], 10.0f);
+    riaecs::RemoveComponent<GroupVelocityComponent>(world, entities[0]);
+    world.DestroyEntity(entities[2]);
+
+    auto expectPacked = [&world, groupID]()
+    {
+        riaecs::ReadOnlyObject<riaecs::GroupData> group = world.GetGroup(groupID);
+        const riaecs::GroupData &data = group();
+
+        // Both dense arrays start with the members in the same order
+        const std::vector<riaecs::Entity> &positions = world.View(riaecs::ComponentType<GroupPositionComponent>::GetID())();
+        const std::vector<riaecs::Entity> &velocities = world.View(riaecs::ComponentType<GroupVelocityComponent>::GetID())();
+        for (size_t i = 0; i < data.size; ++i)
+        {
+            EXPECT_EQ(positions[i], data.entities[i]);
+            EXPECT_EQ(velocities[i], data.entities[i]);
+        }
+
+        for (size_t i = data.size; i < positions.size(); ++i)
+            EXPECT_FALSE(world.HasComponent(positions[i], riaecs::ComponentType<GroupVelocityComponent>::GetID()));
+    };
+    expectPacked();
+
+    std::unordered_set<size_t> members;
+    riaecs::ForEachInGroup<GroupPositionComponent, GroupVelocityComponent>
+    (
+        world, groupID, 
+        [&members](const riaecs::Entity &entity, const GroupPositionComponent &position, const GroupVelocityComponent &velocity)
+        {
+            EXPECT_EQ(velocity.v, position.x * 10.0f);
+            members.insert(entity.GetIndex());
+        }
+    );
+    EXPECT_EQ(members, (std::unordered_set<size_t>{1, 4, 6, 8}));
+
+    // Writing through the group marks the members changed, reading does not
+    uint64_t sinceTick = world.GetTick();
+    world.AdvanceTick();
+    EXPECT_TRUE(riaecs::Changed<GroupVelocityComponent>(world, sinceTick).empty());
+
+    riaecs::ForEachInGroupMutable<GroupPositionComponent, GroupVelocityComponent>
+    (
+        world, groupID, 
+        [](const riaecs::Entity &, GroupPositionComponent &position, GroupVelocityComponent &velocity)
+        {
+            position.x += 1.0f;
+            velocity.v = position.x * 10.0f;
+        }
+    );
+
+    std::vector<riaecs::Entity> changed = riaecs::Changed<GroupVelocityComponent>(world, sinceTick);
+    std::unordered_set<size_t> changedIndices;
+    for (const riaecs::Entity &entity : changed)
+        changedIndices.insert(entity.GetIndex());
+    EXPECT_EQ(changedIndices, members);
+    EXPECT_EQ(riaecs::Changed<GroupPositionComponent>(world, sinceTick).size(), members.size());
+
+    // Compaction keeps the front packed and in step
+    world.Compact();
+    expectPacked();
+    EXPECT_EQ(world.GetGroup(groupID)().size, 4);
+
+    // Owned storages cannot be sorted or owned twice
+    EXPECT_THROW
+    (
+        riaecs::SortComponentByKey<GroupPositionComponent>(world, [](const GroupPositionComponent &c) { return c.x; }), 
+        std::runtime_error
+    );
+    EXPECT_THROW(riaecs::CreateGroup<GroupVelocityComponent>(world), std::runtime_error);
+
+    world.Clear();
+    EXPECT_EQ(world.GetGroup(groupID)().size, 0);
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, SplitComponent)
+{
+    constexpr size_t ENTITY_COUNT = 4;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<SplitBodyComponent, SplitPlainComponent>(world, ENTITY_COUNT);
+
+    // Only the hot part is stored in the component's own blocks
+    const riaecs::ComponentMeta &meta = world.GetComponentMeta(riaecs::ComponentType<SplitBodyComponent>::GetID());
+    EXPECT_EQ(meta.size, sizeof(SplitBodyComponent::Hot));
+    ASSERT_NE(meta.cold, nullptr);
+    EXPECT_EQ(meta.cold->size, sizeof(SplitBodyComponent::Cold));
+
+    riaecs::Entity entity = world.CreateEntity();
+    riaecs::EmplaceComponent<SplitBodyComponent>(world, entity, 1, 2.0f, 3.0);
+    {
+        riaecs::ReadOnlyObject<const SplitBodyComponent::Hot*> hot = riaecs::GetComponent<SplitBodyComponent>(world, entity);
+        EXPECT_EQ(hot()->intValue, 1);
+        EXPECT_EQ(hot()->floatValue, 2.0f);
+        EXPECT_EQ(hot()->doubleValue, 3.0);
+    }
+
+    // The cold part starts default constructed and is only touched on request
+    uint64_t sinceTick = world.GetTick();
+    world.AdvanceTick();
+    {
+        riaecs::ReadOnlyObject<SplitBodyComponent::Cold*> cold = riaecs::GetMutableColdComponent<SplitBodyComponent>(world, entity);
+        EXPECT_TRUE(cold()->name.empty());
+        cold()->name = "a name long enough to live on the heap";
+    }
+    EXPECT_EQ(riaecs::Changed<SplitBodyComponent>(world, sinceTick), std::vector<riaecs::Entity>{entity});
+
+    // Instances copy both parts
+    std::vector<riaecs::Entity> instances;
+    world.Instantiate(world.CreatePrefab(entity), 2, instances);
+    for (const riaecs::Entity &instance : instances)
+    {
+        EXPECT_EQ(riaecs::GetComponent<SplitBodyComponent>(world, instance)()->intValue, 1);
+        EXPECT_EQ
+        (
+            riaecs::GetColdComponent<SplitBodyComponent>(world, instance)()->name, 
+            "a name long enough to live on the heap"
+        );
+    }
+
+    riaecs::RemoveComponent<SplitBodyComponent>(world, instances[0]);
+    EXPECT_EQ(riaecs::GetColdComponent<SplitBodyComponent>(world, instances[0])(), nullptr);
+    world.DestroyEntity(instances[1]);
+
+    // Compact lays out the cold parts in entity order as well
+    {
+        std::vector<riaecs::Entity> others;
+        for (size_t i = 1; i < ENTITY_COUNT; ++i)
+            others.push_back(world.CreateEntity());
+
+        for (size_t i = others.size(); i > 0; --i)
+        {
+            riaecs::EmplaceComponent<SplitBodyComponent>(world, others[i - 1], static_cast<int>(i), 0.0f, 0.0);
+            riaecs::GetMutableColdComponent<SplitBodyComponent>(world, others[i - 1])()->name = std::to_string(i);
+        }
+
+        world.Compact();
+
+        {
+            riaecs::ReadOnlyObject<std::vector<riaecs::Entity>> view = riaecs::View<SplitBodyComponent>(world);
+            const std::byte *previous = nullptr;
+            for (const riaecs::Entity &other : view())
+            {
+                const std::byte *cold = world.GetColdComponent(other, riaecs::ComponentType<SplitBodyComponent>::GetID())();
+                if (previous)
+                {
+                    EXPECT_GT(cold, previous);
+                }
+                previous = cold;
+            }
+        }
+
+        for (size_t i = 0; i < others.size(); ++i)
+            EXPECT_EQ(riaecs::GetColdComponent<SplitBodyComponent>(world, others[i])()->name, std::to_string(i + 1));
+
+        for (const riaecs::Entity &other : others)
+            world.DestroyEntity(other);
+    }
+
+    // Unsplit components have no cold part, the typed accessor does not even compile for them
+    riaecs::AddComponent<SplitPlainComponent>(world, entity);
+    EXPECT_THROW
+    (
+        world.GetColdComponent(entity, riaecs::ComponentType<SplitPlainComponent>::GetID()), std::runtime_error
+    );
+
+    world.DestroyWorld();
+}
+
+TEST(ECS, SharedComponent)
+{
+    // The pool only holds the distinct values, never more than three at a time here
+    constexpr size_t DISTINCT_VALUE_COUNT = 3;
+
+    riaecs::ECSWorld world;
+    CreateTypedWorld<SharedConfigComponent>(world, DISTINCT_VALUE_COUNT);
+
+    // Four slow entities and two fast ones
+    std::vector<riaecs::Entity> entities;
+    for (size_t i = 0; i < 6; ++i)
+    {
+        riaecs::Entity entity = world.CreateEntity();
+        if (i < 4)
+            riaecs::EmplaceComponent<SharedConfigComponent>(world, entity, "slow", 1);
+        else
+            riaecs::EmplaceComponent<SharedConfigComponent>(world, entity, "fast", 2);
+        entities.push_back(entity);
+    }
+
+    auto instanceOf = [&world](const riaecs::Entity &entity)
+    {
+        return riaecs::GetComponent<SharedConfigComponent>(world, entity)();
+    };
+    EXPECT_EQ(instanceOf(entities[0]), instanceOf(entities[3]));
+    EXPECT_EQ(instanceOf(entities[4]), instanceOf(entities[5]));
+    EXPECT_NE(instanceOf(entities[0]), instanceOf(entities[4]));
+
+    auto groupSizes = [&world]()
+    {
+        std::map<std::string, size_t> sizes;
+        riaecs::ForEachSharedGroup<SharedConfigComponent>
+        (
+            world, 
+            [&sizes](const SharedConfigComponent &config, const std::vector<riaecs::Entity> &group)
+            {
+                sizes[config.name + std::to_string(config.level)] += group.size();
+            }
+        );
+        return sizes;
+    };
+    EXPECT_EQ(groupSizes(), (std::map<std::string, size_t>{{"fast2", 2}, {"slow1", 4}}));
+
+    // Copy on write leaves the other references untouched
+    uint64_t sinceTick = world.GetTick();
+    world.AdvanceTick();
+    riaecs::ModifySharedComponent<SharedConfigComponent>(world, entities[0], [](SharedConfigComponent &c) { c.level = 3; });
+    EXPECT_EQ(instanceOf(entities[0])->level, 3);
+    EXPECT_EQ(instanceOf(entities[1])->level, 1);
+    EXPECT_EQ(riaecs::Changed<SharedConfigComponent>(world, sinceTick), std::vector<riaecs::Entity>{entities[0]});
+    EXPECT_EQ(groupSizes(), (std::map<std::string, size_t>{{"fast2", 2}, {"slow1", 3}, {"slow3", 1}}));
+
+    // Modifying back to an existing value shares it again
+    riaecs::ModifySharedComponent<SharedConfigComponent>(world, entities[0], [](SharedConfigComponent &c) { c.level = 1; });
+    EXPECT_EQ(instanceOf(entities[0]), instanceOf(entities[1]));
+
+    EXPECT_THROW
+    (
+        world.GetMutableComponent(entities[0], riaecs::ComponentType<SharedConfigComponent>::GetID()), 
+        std::runtime_error
+    );
+
+    // Shared instances are read only through the typed accessor and cannot be owned by a group
+    static_assert(std::is_same_v
+    <
+        decltype(riaecs::GetComponent<SharedConfigComponent>(world, entities[0])()), const SharedConfigComponent*
+    >);
+    EXPECT_THROW(riaecs::CreateGroup<SharedConfigComponent>(world), std::runtime_error);
+
+    // Instances reference the template's value
+    std::vector<riaecs::Entity> instances;
+    world.Instantiate(world.CreatePrefab(entities[4]), 2, instances);
+    EXPECT_EQ(instanceOf(instances[0]), instanceOf(entities[4]));
+
+    // The value is freed with its last reference
+    world.DestroyEntity(entities[4]);
+    world.DestroyEntity(entities[5]);
+    world.DestroyEntities(instances);
+    EXPECT_EQ(groupSizes(), (std::map<std::string, size_t>{{"slow1", 4}}));
+
+    world.Compact();
+    EXPECT_EQ(instanceOf(entities[2])->name, "slow");
+
+    // More distinct values than the max count do not fit, however few entities there are
+    riaecs::Entity other = world.CreateEntity();
+    riaecs::EmplaceComponent<SharedConfigComponent>(world, other, "a", 1);
+    riaecs::EmplaceComponent<SharedConfigComponent>(world, world.CreateEntity(), "b", 1);
+    EXPECT_THROW
+    (
+        riaecs::EmplaceComponent<SharedConfigComponent>(world, world.CreateEntity(), "c", 1), std::runtime_error
+    );
+
+    // The untyped accessor is read only as well
+    static_assert(std::is_same_v
+    <
+        decltype(world.GetComponent(other, riaecs::ComponentType<SharedConfigComponent>::GetID())()), const std::byte*
+    >);
+    riaecs::RemoveComponent<SharedConfigComponent>(world, other);
+    riaecs::EmplaceComponent<SharedConfigComponent>(world, other, "a", 1);
+    EXPECT_EQ(instanceOf(other)->name, "a");
+
+    world.DestroyWorld();
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+﻿#include "riaecs_unit_test/pch.h"
+
+#include "riaecs/include/file.h"
+#pragma comment(lib, "riaecs.lib")
+
+#include <filesystem>
+#include <fstream>
+
+TEST(File, ChunkReader)
+{
+    // Write a test file which is not a multiple of the chunk size
+    const size_t FILE_SIZE = 10000;
+    std::filesystem::path filePath = std::filesystem::temp_directory_path() / "riaecs_chunk_reader_test.bin";
+    {
+        std::ofstream file(filePath, std::ios::binary);
+        for (size_t i = 0; i < FILE_SIZE; ++i)
+            file.put(static_cast<char>(i % 251));
+    }
+
+    riaecs::BinaryFileLoader fileLoader;
+
+    // Load the whole file
+    {
+        std::unique_ptr<riaecs::IFileData> fileData = fileLoader.Load(filePath.string());
+        riaecs::MemoryFileData &memoryData = dynamic_cast<riaecs::MemoryFileData&>(*fileData);
+        EXPECT_EQ(memoryData.GetSize(), FILE_SIZE);
+        EXPECT_EQ(memoryData.GetData()[FILE_SIZE - 1], static_cast<std::byte>((FILE_SIZE - 1) % 251));
+    }
+
+    // Read the file in chunks
+    {
+        const size_t CHUNK_SIZE = 1024;
+        riaecs::FileChunkReader chunkReader(fileLoader.Open(filePath.string()), CHUNK_SIZE, 2);
+        EXPECT_EQ(chunkReader.GetSize(), FILE_SIZE);
+
+        size_t offset = 0;
+        size_t chunkCount = 0;
+        const std::byte *data = nullptr;
+        size_t size = 0;
+        while (chunkReader.Next(data, size))
+        {
+            EXPECT_LE(size, CHUNK_SIZE);
+            for (size_t i = 0; i < size; ++i)
+                ASSERT_EQ(data[i], static_cast<std::byte>((offset + i) % 251));
+
+            offset += size;
+            chunkCount++;
+        }
+        EXPECT_EQ(offset, FILE_SIZE);
+        EXPECT_EQ(chunkCount, (FILE_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+        // Read an arbitrary byte range
+        std::byte range[16];
+        EXPECT_EQ(chunkReader.ReadRange(5000, range, sizeof(range)), sizeof(range));
+        EXPECT_EQ(range[0], static_cast<std::byte>(5000 % 251));
+        EXPECT_EQ(chunkReader.ReadRange(FILE_SIZE - 4, range, sizeof(range)), 4);
+    }
+
+    // Destroy the reader before consuming all chunks
+    {
+        riaecs::FileChunkReader chunkReader(fileLoader.Open(filePath.string()), 16, 1);
+        const std::byte *data = nullptr;
+        size_t size = 0;
+        EXPECT_TRUE(chunkReader.Next(data, size));
+    }
+
+    std::filesystem::remove(filePath);
+}
\ No newline at end of file
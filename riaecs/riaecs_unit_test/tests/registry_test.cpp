@@ -56,4 +56,26 @@ TEST(Registry, Use)
         riaecs::ReadOnlyObject<ITestFactory> factoryB = registry.Get(idB);
         EXPECT_EQ(factoryB().Create(), TEST_FACTORY_B);
     }
+}
+
+TEST(Registry, Freeze)
+{
+    riaecs::Registry<size_t> registry;
+    size_t id = registry.Add(std::make_unique<size_t>(TEST_FACTORY_B));
+    EXPECT_FALSE(registry.IsFrozen());
+
+    registry.Freeze();
+    EXPECT_TRUE(registry.IsFrozen());
+
+    // Frozen lookups hand out the entry without holding the lock
+    {
+        riaecs::ReadOnlyObject<size_t> entry = registry.Get(id);
+        EXPECT_EQ(entry(), TEST_FACTORY_B);
+        EXPECT_FALSE(entry.TakeLock().owns_lock());
+    }
+
+    EXPECT_EQ(registry.GetCount(), 1);
+    EXPECT_THROW(registry.Get(1), std::runtime_error);
+    EXPECT_THROW(registry.Add(std::make_unique<size_t>(TEST_FACTORY_A)), std::runtime_error);
+    EXPECT_EQ(registry.GetCount(), 1);
 }
\ No newline at end of file
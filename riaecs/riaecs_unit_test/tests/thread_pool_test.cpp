@@ -0,0 +1,29 @@
+﻿#include "riaecs_unit_test/pch.h"
+
+#include "riaecs/include/thread_pool.h"
+#pragma comment(lib, "riaecs.lib")
+
+#include <atomic>
+
+TEST(ThreadPool, Submit)
+{
+    riaecs::ThreadPool pool(4);
+    EXPECT_EQ(pool.GetThreadCount(), 4);
+
+    const int TASK_COUNT = 100;
+    std::atomic<int> completedCount = 0;
+    for (int i = 0; i < TASK_COUNT; ++i)
+        pool.Submit([&completedCount]() { completedCount++; });
+
+    pool.WaitIdle();
+    EXPECT_EQ(completedCount, TASK_COUNT);
+
+    // Tasks may submit other tasks
+    pool.Submit([&pool, &completedCount]() 
+    { 
+        pool.Submit([&completedCount]() { completedCount++; }); 
+    });
+
+    pool.WaitIdle();
+    EXPECT_EQ(completedCount, TASK_COUNT + 1);
+}
\ No newline at end of file